@@ -11,88 +11,170 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <algorithm>
 #include <cstring>
+#include <new>
+#include <vector>
 
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     size_t max_pool_size)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type, max_pool_size) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
-    : pool_size_(pool_size),
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type, size_t max_pool_size,
+                                                     const PageRouter *router)
+    : max_pool_size_(std::max(pool_size, max_pool_size)),
       num_instances_(num_instances),
       instance_index_(instance_index),
-      next_page_id_(instance_index),
+      owned_router_(router == nullptr ? std::make_unique<ModuloPageRouter>(num_instances) : nullptr),
+      router_(router == nullptr ? owned_router_.get() : router),
+      allocator_(disk_manager->GetFreeSpaceMap(), router_, instance_index),
+      arena_(max_pool_size_, sizeof(Page),
+             num_instances > 1 ? static_cast<int>(instance_index % FrameArena::NumNumaNodes()) : -1),
       disk_manager_(disk_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager),
+      page_table_(max_pool_size_),
+      frame_strategies_(max_pool_size_) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  // We allocate a consecutive memory space for the buffer pool: the arena reserves it for the largest the pool can
+  // grow to, and each instance of a parallel BPM places it on its own NUMA node.
+  pages_ = static_cast<Page *>(arena_.GetDescriptors());
+  switch (replacer_type) {
+    case ReplacerType::LRU:
+      replacer_ = new LRUReplacer(max_pool_size_);
+      break;
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(max_pool_size_, LRUK_REPLACER_K, LRUK_CORRELATED_PERIOD);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(max_pool_size_);
+      break;
+  }
 
   // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
-    pages_[i].page_id_ = INVALID_PAGE_ID;
-    pages_[i].is_dirty_ = false;
-    pages_[i].pin_count_ = 0;
-  }
+  AddFrames(pool_size);
+
+  background_writer_ = std::thread(&BufferPoolManagerInstance::RunBackgroundWriter, this);
+  read_ahead_thread_ = std::thread(&BufferPoolManagerInstance::RunReadAhead, this);
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  // unpinning does not write pages back, so the pages still dirty would be lost; the disk manager must still be open
+  FlushAllPgsImp();
+  {
+    std::lock_guard<TimedMutex> lg(latch_);
+    stop_threads_ = true;
+  }
+  background_writer_cv_.notify_one();
+  read_ahead_cv_.notify_one();
+  background_writer_.join();
+  read_ahead_thread_.join();
+  for (size_t i = 0; i < num_constructed_frames_; ++i) {
+    pages_[i].~Page();
+  }
   delete replacer_;
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
   // Make sure you call DiskManager::WritePage!
-  std::lock_guard<std::mutex> lg(latch_);
-  auto frame_id = FindPg(page_id);
+  std::unique_lock<TimedMutex> lock(latch_);
+  auto frame_id = FindPgOrWait(page_id, &lock);
   if (frame_id == -1) {
     return false;
   }
 
-  if (pages_[frame_id].IsDirty()) {
-    disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
+  // written with latch_ released and the page read-latched, like the background writer's writes
+  if (pages_[frame_id].is_dirty_) {
+    CleanPg(frame_id, &lock);
   }
-  pages_[frame_id].is_dirty_ = false;
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  // You can do it!
-  for (const auto &page : page_table_) {
-    FlushPgImp(page.first);
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty;
+  {
+    std::lock_guard<TimedMutex> lg(latch_);
+    for (size_t i = 0; i < pool_size_; ++i) {
+      if (pages_[i].page_id_ != INVALID_PAGE_ID && pages_[i].is_dirty_) {
+        dirty.emplace_back(pages_[i].page_id_, static_cast<frame_id_t>(i));
+      }
+    }
+  }
+  std::sort(dirty.begin(), dirty.end());
+  std::vector<std::pair<page_id_t, frame_id_t>> batch;
+  for (size_t begin = 0; begin < dirty.size(); begin += FLUSH_BATCH_SIZE) {
+    size_t end = std::min<size_t>(begin + FLUSH_BATCH_SIZE, dirty.size());
+    batch.assign(dirty.begin() + begin, dirty.begin() + end);
+    FlushBatch(batch);
   }
 }
 
 auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+  return NewPgNearImp(INVALID_PAGE_ID, page_id);
+}
+
+auto BufferPoolManagerInstance::NewPgNearImp(page_id_t near_page_id, page_id_t *page_id) -> Page * {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  std::lock_guard<std::mutex> lg(latch_);
-  auto frame_id = GetPg();
+  std::unique_lock<TimedMutex> lock(latch_);
+  page_id_t victim_page_id;
+  auto frame_id = GetPg(&victim_page_id);
+  while (frame_id == -1 && WaitForCleaning(&lock)) {
+    frame_id = GetPg(&victim_page_id);
+  }
   if (frame_id == -1) {
     return nullptr;
   }
 
-  pages_[frame_id].page_id_ = *page_id = AllocatePage();
-  pages_[frame_id].pin_count_++;
-  page_table_[*page_id] = frame_id;
+  pages_[frame_id].version_++;
+  bool new_extent;
+  pages_[frame_id].page_id_ = *page_id = AllocatePage(near_page_id, &new_extent);
+  pages_[frame_id].io_in_progress_ = true;
+  page_table_.Insert(*page_id, frame_id);
+  replacer_->Pin(frame_id);
+  pages_[frame_id].pin_count_ = 1;
+  lock.unlock();
+
+  if (new_extent) {
+    page_id_t first_page_id;
+    page_id_t end_page_id;
+    allocator_.GetExtentRange(*page_id, &first_page_id, &end_page_id);
+    disk_manager_->PreallocatePages(first_page_id, end_page_id);
+  }
+  DoPgIo(frame_id, victim_page_id, INVALID_PAGE_ID);
   memset(pages_[frame_id].GetData(), 0, PAGE_SIZE);
+
+  lock.lock();
+  FinishPgIo(frame_id, victim_page_id);
   return &pages_[frame_id];
 }
 
 auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
+  return FetchPgImp(page_id, AccessStrategy::NORMAL);
+}
+
+auto BufferPoolManagerInstance::FetchScanPgImp(page_id_t page_id, ScanHandle *scan) -> Page * {
+  ScanHandle::Window *window = scan->GetWindow(instance_index_);
+  if (window->last_page_id_ != page_id) {
+    std::lock_guard<TimedMutex> lg(latch_);
+    ReadAhead(page_id, window);
+  }
+  return FetchPgImp(page_id, AccessStrategy::SEQUENTIAL);
+}
+
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id, AccessStrategy strategy) -> Page * {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -100,27 +182,210 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  std::lock_guard<std::mutex> lg(latch_);
-  auto frame_id = FindPg(page_id);
+  // Steps 2 and 4 run with latch_ released: the frame is reserved (pinned and mapped to P) first, and concurrent
+  // fetches of P wait on its io_in_progress_ flag instead of issuing a second read.
+  // Step 1.1 does not take latch_ at all unless the page has to leave a scan's ring.
+  auto frame_id = TryPinPg(page_id);
   if (frame_id != -1) {
-    replacer_->Pin(frame_id);
-    pages_[frame_id].pin_count_++;
-    pages_[frame_id].is_dirty_ = true;
+    hits_.Add();
+    if (strategy == AccessStrategy::NORMAL) {
+      LeaveRing(frame_id);
+    }
     return &pages_[frame_id];
   }
-  frame_id = GetPg();
-  if (frame_id != -1) {
-    page_table_[page_id] = frame_id;
-    replacer_->Pin(frame_id);
-    pages_[frame_id].page_id_ = page_id;
-    pages_[frame_id].pin_count_++;
-    pages_[frame_id].is_dirty_ = false;
-    disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
 
-    return &pages_[frame_id];
+  std::unique_lock<TimedMutex> lock(latch_);
+  while (true) {
+    frame_id = FindPgOrWait(page_id, &lock);
+    if (frame_id != -1) {
+      hits_.Add();
+      if (strategy == AccessStrategy::NORMAL) {
+        SetFrameStrategy(frame_id, AccessStrategy::NORMAL);
+      }
+      PinFrame(frame_id);
+      return &pages_[frame_id];
+    }
+    bool read_failed;
+    frame_id = LoadPg(page_id, strategy, &lock, &read_failed);
+    // while waiting for the background writer, another thread may read the page in
+    if (frame_id != -1 || read_failed || !WaitForCleaning(&lock)) {
+      return frame_id == -1 ? nullptr : &pages_[frame_id];
+    }
+  }
+}
+
+auto BufferPoolManagerInstance::OptimisticFetchPgImp(page_id_t page_id, uint64_t *version) -> Page * {
+  auto frame_id = page_table_.Find(page_id);
+  if (frame_id == -1) {
+    return nullptr;
+  }
+  // The version has to be taken before the page id is checked: reassigning the frame bumps it before changing the id.
+  Page *page = &pages_[frame_id];
+  *version = page->GetVersion();
+  if (*version % 2 != 0 || page->page_id_ != page_id) {
+    return nullptr;
+  }
+  return page;
+}
+
+auto BufferPoolManagerInstance::FetchSwizzledPgImp(Page *page, page_id_t page_id) -> Page * {
+  // the reference may be to a frame of another instance if the caller mixed up buffer pools
+  if (page < pages_ || page >= pages_ + max_pool_size_) {
+    return nullptr;
+  }
+  auto frame_id = static_cast<frame_id_t>(page - pages_);
+  if (!TryPinFrame(frame_id, page_id)) {
+    return nullptr;
+  }
+  hits_.Add();
+  LeaveRing(frame_id);
+  return page;
+}
+
+auto BufferPoolManagerInstance::SwizzlePgImp(Page *page, SwizzleOwner *owner) -> bool {
+  if (page < pages_ || page >= pages_ + max_pool_size_) {
+    return false;
   }
+  // the page is pinned, so UnswizzleFrame cannot run on it concurrently
+  SwizzleOwner *current_owner = nullptr;
+  return page->swizzle_owner_.compare_exchange_strong(current_owner, owner) || current_owner == owner;
+}
 
-  return nullptr;
+void BufferPoolManagerInstance::UnswizzleAllImp(SwizzleOwner *owner) {
+  std::lock_guard<TimedMutex> lg(latch_);
+  for (size_t i = 0; i < num_constructed_frames_; ++i) {
+    SwizzleOwner *current_owner = owner;
+    pages_[i].swizzle_owner_.compare_exchange_strong(current_owner, nullptr);
+  }
+}
+
+void BufferPoolManagerInstance::FetchPgsImp(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages,
+                                            AccessStrategy strategy) {
+  FetchPgs(page_ids, pages, strategy, false);
+}
+
+void BufferPoolManagerInstance::FetchPgs(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages,
+                                         AccessStrategy strategy, bool speculative) {
+  pages->assign(page_ids.size(), nullptr);
+  std::vector<size_t> misses;
+  std::vector<frame_id_t> promotions;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    auto frame_id = TryPinPg(page_ids[i]);
+    if (frame_id == -1) {
+      misses.push_back(i);
+      continue;
+    }
+    (*pages)[i] = &pages_[frame_id];
+    hits_.Add();
+    if (strategy == AccessStrategy::NORMAL && frame_strategies_[frame_id] != AccessStrategy::NORMAL) {
+      promotions.push_back(frame_id);
+    }
+  }
+  if (misses.empty() && promotions.empty()) {
+    return;
+  }
+
+  struct Load {
+    page_id_t page_id_;
+    frame_id_t frame_id_;
+    page_id_t victim_page_id_;
+  };
+  std::vector<Load> loads;
+  std::vector<size_t> deferred;
+  {
+    std::unique_lock<TimedMutex> lock(latch_);
+    for (auto frame_id : promotions) {
+      SetFrameStrategy(frame_id, AccessStrategy::NORMAL);
+    }
+    for (size_t miss = 0; miss < misses.size(); ++miss) {
+      size_t i = misses[miss];
+      page_id_t page_id = page_ids[i];
+      auto frame_id = FindPg(page_id);
+      if (frame_id != -1 && !pages_[frame_id].io_in_progress_) {
+        if (strategy == AccessStrategy::NORMAL) {
+          SetFrameStrategy(frame_id, AccessStrategy::NORMAL);
+        }
+        PinFrame(frame_id);
+        hits_.Add();
+        (*pages)[i] = &pages_[frame_id];
+        continue;
+      }
+      auto load = std::find_if(loads.begin(), loads.end(), [page_id](const Load &l) { return l.page_id_ == page_id; });
+      if (load != loads.end()) {
+        // a duplicate of a page this batch is reading in
+        PinFrame(load->frame_id_);
+        (*pages)[i] = &pages_[load->frame_id_];
+        continue;
+      }
+      if (frame_id != -1 || pages_in_writeback_.count(page_id) != 0) {
+        // somebody else's I/O; waiting for it while holding reservations of our own could deadlock
+        deferred.push_back(i);
+        continue;
+      }
+      if (!IsAllocated(page_id)) {
+        continue;
+      }
+      page_id_t victim_page_id;
+      frame_id = ReservePg(page_id, strategy, &victim_page_id, speculative);
+      if (frame_id != -1) {
+        loads.push_back({page_id, frame_id, victim_page_id});
+        (*pages)[i] = &pages_[frame_id];
+      } else if (!speculative && WaitForCleaning(&lock)) {
+        // look the page up again, somebody may have read it in meanwhile
+        --miss;
+      }
+    }
+  }
+
+  std::sort(loads.begin(), loads.end(), [](const Load &a, const Load &b) { return a.page_id_ < b.page_id_; });
+  std::vector<page_id_t> read_page_ids;
+  std::vector<char *> read_buffers;
+  // the victims are written back all at once, and each must be on disk before its frame is read into
+  std::vector<std::future<bool>> victim_writes;
+  for (const auto &load : loads) {
+    if (load.victim_page_id_ != INVALID_PAGE_ID) {
+      victim_writes.push_back(disk_manager_->WritePageAsync(load.victim_page_id_, pages_[load.frame_id_].GetData()));
+      eviction_writes_.fetch_add(1, std::memory_order_relaxed);
+    }
+    read_page_ids.push_back(load.page_id_);
+    read_buffers.push_back(pages_[load.frame_id_].GetData());
+  }
+  for (auto &write : victim_writes) {
+    write.wait();
+  }
+  std::vector<bool> intact;
+  if (!read_page_ids.empty()) {
+    disk_manager_->ReadPages(read_page_ids, read_buffers, &intact);
+  }
+  {
+    std::lock_guard<TimedMutex> lg(latch_);
+    for (size_t l = 0; l < loads.size(); ++l) {
+      const auto &load = loads[l];
+      if (intact[l]) {
+        FinishPgIo(load.frame_id_, load.victim_page_id_);
+        continue;
+      }
+      // a page that could not be read is not handed out, neither where it was asked for nor to its duplicates
+      bool reservation = true;
+      for (auto &page : *pages) {
+        if (page == &pages_[load.frame_id_]) {
+          page = nullptr;
+          if (!reservation) {
+            UnpinFrame(load.frame_id_);
+          }
+          reservation = false;
+        }
+      }
+      AbortPgIo(load.frame_id_, load.victim_page_id_);
+    }
+  }
+
+  if (speculative) {
+    return;
+  }
+  for (auto i : deferred) {
+    (*pages)[i] = FetchPgImp(page_ids[i], strategy);
+  }
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
@@ -129,82 +394,690 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  std::lock_guard<std::mutex> lg(latch_);
-  DeallocatePage(page_id);
-  auto frame_id = FindPg(page_id);
-  if (frame_id == -1) {
+  std::unique_lock<TimedMutex> lock(latch_);
+  // a page on its way to disk has to get there before its space is given back, or it would land in the hole
+  auto frame_id = FindPgOrWait(page_id, &lock);
+  if (frame_id == -1 && !IsAllocated(page_id)) {
     return true;
   }
-  if (pages_[frame_id].GetPinCount() != 0) {
+  if (frame_id != -1 && !ClaimFrame(frame_id)) {
     return false;
   }
+  if (frame_id != -1) {
+    RemoveFrame(frame_id);
+  }
+  // fetches of the page wait until it is freed, and then find it is no longer allocated
+  pages_in_writeback_.insert(page_id);
+  lock.unlock();
+
+  // the id is handed out again only once its old contents are gone
+  disk_manager_->DeallocatePage(page_id);
+  lock.lock();
+  DeallocatePage(page_id);
+  pages_in_writeback_.erase(page_id);
+  io_cv_.notify_all();
+  return true;
+}
 
-  page_table_.erase(page_id);
+void BufferPoolManagerInstance::RemoveFrame(frame_id_t frame_id) {
+  const page_id_t page_id = pages_[frame_id].page_id_;
+  UnswizzleFrame(frame_id);
+  page_table_.Erase(page_id);
+  replacer_->Remove(frame_id);
+  SetFrameStrategy(frame_id, AccessStrategy::NORMAL);
+  pages_[frame_id].version_++;
   pages_[frame_id].page_id_ = INVALID_PAGE_ID;
   pages_[frame_id].is_dirty_ = false;
   memset(pages_[frame_id].GetData(), 0, PAGE_SIZE);
+  pages_[frame_id].version_.fetch_add(1, std::memory_order_release);
   free_list_.emplace_back(frame_id);
+}
 
-  return true;
+auto BufferPoolManagerInstance::ResizePoolImp(size_t pool_size) -> size_t {
+  std::lock_guard<std::mutex> resize_lg(resize_latch_);
+  pool_size = std::clamp<size_t>(pool_size, 1, max_pool_size_);
+  std::unique_lock<TimedMutex> lock(latch_);
+  if (pool_size >= pool_size_) {
+    AddFrames(pool_size);
+    return pool_size_;
+  }
+
+  // Write back the pages of the frames to be retired first, so that withdrawing the frames does not need any I/O.
+  std::vector<page_id_t> dirty_page_ids;
+  for (size_t i = pool_size; i < pool_size_; ++i) {
+    if (pages_[i].page_id_ != INVALID_PAGE_ID && pages_[i].is_dirty_) {
+      dirty_page_ids.push_back(pages_[i].page_id_);
+    }
+  }
+  lock.unlock();
+  for (auto page_id : dirty_page_ids) {
+    FlushPgImp(page_id);
+  }
+  lock.lock();
+
+  // Frames are retired from the end, so the remaining ones are still numbered from 0 to pool_size_ - 1.
+  size_t new_pool_size = pool_size_;
+  while (new_pool_size > pool_size && WithdrawFrame(static_cast<frame_id_t>(new_pool_size - 1), pool_size)) {
+    new_pool_size--;
+  }
+  ReleaseFrames(new_pool_size);
+  return pool_size_;
+}
+
+void BufferPoolManagerInstance::GetResidentPgsImp(std::vector<page_id_t> *page_ids) {
+  std::vector<frame_id_t> eviction_order;
+  std::lock_guard<TimedMutex> lg(latch_);
+  replacer_->GetEvictionOrder(&eviction_order);
+  page_ids->clear();
+  std::vector<bool> listed(pool_size_, false);
+  auto list = [&](frame_id_t frame_id) {
+    if (static_cast<size_t>(frame_id) >= pool_size_ || listed[frame_id] ||
+        pages_[frame_id].page_id_ == INVALID_PAGE_ID || pages_[frame_id].io_in_progress_ ||
+        frame_strategies_[frame_id] != AccessStrategy::NORMAL) {
+      return;
+    }
+    listed[frame_id] = true;
+    page_ids->push_back(pages_[frame_id].page_id_);
+  };
+  // pinned pages are in use right now
+  for (size_t i = 0; i < pool_size_; ++i) {
+    if (pages_[i].pin_count_ > 0) {
+      list(static_cast<frame_id_t>(i));
+    }
+  }
+  std::for_each(eviction_order.rbegin(), eviction_order.rend(), list);
+}
+
+auto BufferPoolManagerInstance::PrefetchPgsImp(const std::vector<page_id_t> &page_ids) -> size_t {
+  std::vector<page_id_t> missing;
+  for (auto page_id : page_ids) {
+    if (FindPg(page_id) == -1) {
+      missing.push_back(page_id);
+    }
+  }
+  std::sort(missing.begin(), missing.end());
+  missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+  size_t num_read = 0;
+  std::vector<page_id_t> batch;
+  std::vector<Page *> pages;
+  for (size_t begin = 0; begin < missing.size(); begin += READ_AHEAD_MAX_DEPTH) {
+    batch.assign(missing.begin() + begin, missing.begin() + std::min(begin + READ_AHEAD_MAX_DEPTH, missing.size()));
+    FetchPgs(batch, &pages, AccessStrategy::NORMAL, true);
+    bool out_of_frames = false;
+    for (auto *page : pages) {
+      if (page == nullptr) {
+        out_of_frames = true;
+        continue;
+      }
+      num_read++;
+      UnpinPgImp(page->GetPageId(), false);
+    }
+    if (out_of_frames) {
+      break;
+    }
+  }
+  return num_read;
+}
+
+void BufferPoolManagerInstance::GetStatsImp(std::vector<BufferPoolStats> *stats) {
+  BufferPoolStats instance_stats;
+  instance_stats.instance_index_ = instance_index_;
+  instance_stats.pool_size_ = pool_size_;
+  instance_stats.hits_ = hits_.Load();
+  instance_stats.misses_ = misses_.load(std::memory_order_relaxed);
+  instance_stats.prefetches_ = prefetches_.load(std::memory_order_relaxed);
+  instance_stats.evictions_ = evictions_.load(std::memory_order_relaxed);
+  instance_stats.eviction_writes_ = eviction_writes_.load(std::memory_order_relaxed);
+  instance_stats.background_writes_ = background_writes_.load(std::memory_order_relaxed);
+  instance_stats.latch_waits_ = latch_.GetWaits();
+  instance_stats.latch_wait_ns_ = latch_.GetWaitTime();
+  instance_stats.victim_searches_ = victim_searches_.load(std::memory_order_relaxed);
+  instance_stats.victim_search_steps_ = replacer_->GetVictimSearchSteps();
+  stats->assign(1, instance_stats);
 }
 
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
-  std::lock_guard<std::mutex> lg(latch_);
-  auto frame_id = FindPg(page_id);
-  if (frame_id == -1 || pages_[frame_id].pin_count_ == 0) {
+  // The caller's pin keeps the frame from being reassigned, so a page table hit can be trusted once the frame's page
+  // id matches; only a (transient) page table miss needs latch_.
+  auto frame_id = page_table_.Find(page_id);
+  std::unique_lock<TimedMutex> lock(latch_, std::defer_lock);
+  if (frame_id == -1 || pages_[frame_id].page_id_ != page_id) {
+    lock.lock();
+    frame_id = FindPg(page_id);
+    if (frame_id == -1) {
+      return false;
+    }
+  }
+  if (pages_[frame_id].pin_count_ <= 0) {
     return false;
   }
-  pages_[frame_id].is_dirty_ = is_dirty;
-  pages_[frame_id].pin_count_--;
-  if (pages_[frame_id].pin_count_ == 0) {
-    replacer_->Unpin(frame_id);
-    FlushPg(page_id);
+  // only ever set the dirty bit here: an earlier writer's changes are not on disk just because this caller was clean
+  if (is_dirty) {
+    pages_[frame_id].is_dirty_ = true;
   }
+  UnpinFrame(frame_id);
   return true;
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
-  const page_id_t next_page_id = next_page_id_;
-  next_page_id_ += num_instances_;
+auto BufferPoolManagerInstance::HasFreeFrame() -> bool {
+  std::lock_guard<TimedMutex> lg(latch_);
+  return !free_list_.empty();
+}
+
+auto BufferPoolManagerInstance::AllocatePage(page_id_t near_page_id, bool *new_extent) -> page_id_t {
+  const page_id_t next_page_id = allocator_.Allocate(near_page_id, new_extent);
   ValidatePageId(next_page_id);
   return next_page_id;
 }
 
+auto BufferPoolManagerInstance::IsAllocated(page_id_t page_id) const -> bool {
+  return allocator_.IsAllocated(router_->GetLocalIndex(page_id));
+}
+
 void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
-  assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
+  assert(router_->GetInstance(page_id) == instance_index_);  // allocated pages route back to this BPI
 }
 
-auto BufferPoolManagerInstance::FindPg(page_id_t page_id) -> frame_id_t {
-  auto itr = page_table_.find(page_id);
-  if (itr != page_table_.end()) {
-    return itr->second;
+auto BufferPoolManagerInstance::FindPg(page_id_t page_id) -> frame_id_t { return page_table_.Find(page_id); }
+
+auto BufferPoolManagerInstance::TryPinPg(page_id_t page_id) -> frame_id_t {
+  auto frame_id = page_table_.Find(page_id);
+  if (frame_id == -1 || !TryPinFrame(frame_id, page_id)) {
+    return -1;
   }
-  return -1;
+  return frame_id;
 }
 
-auto BufferPoolManagerInstance::GetPg() -> frame_id_t {
-  frame_id_t frame_id;
+auto BufferPoolManagerInstance::TryPinFrame(frame_id_t frame_id, page_id_t page_id) -> bool {
+  Page *page = &pages_[frame_id];
+  int pin_count = page->pin_count_.load();
+  do {
+    if (pin_count < 0) {
+      return false;
+    }
+  } while (!page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1));
+
+  // The frame cannot be reassigned any more, but it may have been since the caller found it.
+  if (page->page_id_ != page_id || page->io_in_progress_) {
+    UnpinFrame(frame_id);
+    return false;
+  }
+  if (pin_count == 0) {
+    replacer_->Pin(frame_id);
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::PinFrame(frame_id_t frame_id) {
+  if (pages_[frame_id].pin_count_.fetch_add(1) == 0) {
+    replacer_->Pin(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::UnpinFrame(frame_id_t frame_id) {
+  // Racing with a 0 -> 1 pin can leave a pinned frame in the replacer; GetPg then fails to claim it and drops it, and
+  // its next last unpin puts it back.
+  if (pages_[frame_id].pin_count_.fetch_sub(1) == 1) {
+    replacer_->Unpin(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::LeaveRing(frame_id_t frame_id) {
+  if (frame_strategies_[frame_id] != AccessStrategy::NORMAL) {
+    // a point access to a page a scan brought in: it is no longer the scan's to recycle
+    std::lock_guard<TimedMutex> lg(latch_);
+    SetFrameStrategy(frame_id, AccessStrategy::NORMAL);
+  }
+}
+
+void BufferPoolManagerInstance::UnswizzleFrame(frame_id_t frame_id) {
+  SwizzleOwner *owner = pages_[frame_id].swizzle_owner_.exchange(nullptr);
+  if (owner != nullptr) {
+    owner->Unswizzle(&pages_[frame_id]);
+  }
+}
+
+auto BufferPoolManagerInstance::ClaimFrame(frame_id_t frame_id) -> bool {
+  int unpinned = 0;
+  return pages_[frame_id].pin_count_.compare_exchange_strong(unpinned, -1);
+}
+
+auto BufferPoolManagerInstance::FindPgOrWait(page_id_t page_id, std::unique_lock<TimedMutex> *lock) -> frame_id_t {
+  while (true) {
+    auto frame_id = FindPg(page_id);
+    if (frame_id != -1 ? !pages_[frame_id].io_in_progress_ : pages_in_writeback_.count(page_id) == 0) {
+      return frame_id;
+    }
+    io_cv_.wait(*lock);
+  }
+}
+
+auto BufferPoolManagerInstance::WaitForCleaning(std::unique_lock<TimedMutex> *lock) -> bool {
+  if (num_cleaning_frames_ == 0) {
+    return false;
+  }
+  io_cv_.wait(*lock, [this] { return num_cleaning_frames_ == 0; });
+  return true;
+}
+
+auto BufferPoolManagerInstance::ReservePg(page_id_t page_id, AccessStrategy strategy, page_id_t *victim_page_id,
+                                          bool speculative) -> frame_id_t {
+  auto frame_id = GetPg(victim_page_id, strategy, speculative);
+  if (frame_id == -1) {
+    return -1;
+  }
+  (speculative ? prefetches_ : misses_).fetch_add(1, std::memory_order_relaxed);
+  // odd until FinishPgIo: optimistic readers of the old page fail from here on
+  pages_[frame_id].version_++;
+  pages_[frame_id].page_id_ = page_id;
+  pages_[frame_id].is_dirty_ = false;
+  pages_[frame_id].io_in_progress_ = true;
+  page_table_.Insert(page_id, frame_id);
+  replacer_->Pin(frame_id);
+  pages_[frame_id].pin_count_ = 1;
+  return frame_id;
+}
+
+auto BufferPoolManagerInstance::LoadPg(page_id_t page_id, AccessStrategy strategy, std::unique_lock<TimedMutex> *lock,
+                                       bool *read_failed) -> frame_id_t {
+  *read_failed = false;
+  if (!IsAllocated(page_id)) {
+    *read_failed = true;
+    return -1;
+  }
+  page_id_t victim_page_id;
+  auto frame_id = ReservePg(page_id, strategy, &victim_page_id);
+  if (frame_id == -1) {
+    return -1;
+  }
+  lock->unlock();
+
+  bool intact = DoPgIo(frame_id, victim_page_id, page_id);
+
+  lock->lock();
+  if (!intact) {
+    *read_failed = true;
+    AbortPgIo(frame_id, victim_page_id);
+    return -1;
+  }
+  FinishPgIo(frame_id, victim_page_id);
+  return frame_id;
+}
+
+void BufferPoolManagerInstance::ReadAhead(page_id_t page_id, ScanHandle::Window *window) {
+  // a scan walks the pages of this instance in allocation order, i.e. by local index, whatever the router's stride
+  const page_id_t last_page_id = window->last_page_id_;
+  if (page_id == last_page_id) {
+    return;
+  }
+  const page_id_t index = router_->GetLocalIndex(page_id);
+  bool sequential = index == (last_page_id == INVALID_PAGE_ID ? -1 : router_->GetLocalIndex(last_page_id)) + 1;
+  window->last_page_id_ = page_id;
+  if (!sequential) {
+    // the start of the scan, or a jump in it; what was queued for its old position may belong to another scan's as
+    // well, so it stays queued and is read in as usual
+    window->depth_ = READ_AHEAD_MIN_DEPTH;
+    window->next_index_ = index + 1;
+    return;
+  }
+
+  size_t capacity;
+  GetRing(AccessStrategy::SEQUENTIAL, &capacity);
+  // the other half of the ring holds the pages the scan is working on and those it has just left
+  int max_depth = std::min<int>(READ_AHEAD_MAX_DEPTH, static_cast<int>(capacity / 2));
+  if (max_depth == 0) {
+    return;
+  }
+  auto frame_id = FindPg(page_id);
+  if (frame_id == -1 || pages_[frame_id].io_in_progress_) {
+    window->depth_ *= 2;
+  }
+  window->depth_ = std::clamp(window->depth_, 1, max_depth);
+
+  window->next_index_ = std::max(window->next_index_, index + 1);
+  bool queued = false;
+  while (window->next_index_ <= index + window->depth_ && allocator_.IsAllocated(window->next_index_)) {
+    read_ahead_queue_.push_back(router_->GetPageId(instance_index_, window->next_index_++));
+    queued = true;
+  }
+  if (queued) {
+    read_ahead_cv_.notify_one();
+  }
+}
+
+void BufferPoolManagerInstance::RunReadAhead() {
+  std::unique_lock<TimedMutex> lock(latch_);
+  std::vector<page_id_t> page_ids;
+  std::vector<Page *> pages;
+  while (true) {
+    read_ahead_cv_.wait(lock, [this] { return stop_threads_ || !read_ahead_queue_.empty(); });
+    if (stop_threads_) {
+      break;
+    }
+    page_ids.clear();
+    for (auto page_id : read_ahead_queue_) {
+      if (FindPg(page_id) == -1) {
+        page_ids.push_back(page_id);
+      }
+    }
+    read_ahead_queue_.clear();
+    lock.unlock();
+
+    FetchPgs(page_ids, &pages, AccessStrategy::SEQUENTIAL, true);
+    for (auto *page : pages) {
+      if (page != nullptr) {
+        UnpinPgImp(page->GetPageId(), false);
+      }
+    }
+    lock.lock();
+  }
+}
+
+auto BufferPoolManagerInstance::GetPg(page_id_t *victim_page_id, AccessStrategy strategy, bool speculative)
+    -> frame_id_t {
+  frame_id_t frame_id = -1;
+  *victim_page_id = INVALID_PAGE_ID;
+  auto evict = [&](frame_id_t frame_id) {
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+    UnswizzleFrame(frame_id);
+    page_id_t page_id = pages_[frame_id].page_id_;
+    if (pages_[frame_id].IsDirty()) {
+      *victim_page_id = page_id;
+      pages_in_writeback_.insert(page_id);
+      background_writer_cv_.notify_one();
+    }
+    page_table_.Erase(page_id);
+    pages_[frame_id].is_dirty_ = false;
+  };
+
+  if (strategy != AccessStrategy::NORMAL) {
+    size_t capacity;
+    if (GetRing(strategy, &capacity)->size() >= capacity) {
+      if ((frame_id = RecycleRingFrame(strategy)) != -1) {
+        evict(frame_id);
+        SetFrameStrategy(frame_id, strategy);
+        return frame_id;
+      }
+      if (speculative) {
+        return -1;
+      }
+    }
+  }
+
   if (!free_list_.empty()) {
     frame_id = free_list_.front();
     free_list_.pop_front();
+    SetFrameStrategy(frame_id, strategy);
     return frame_id;
   }
+  if (speculative && strategy == AccessStrategy::NORMAL) {
+    return -1;
+  }
 
-  if (replacer_->Victim(&frame_id)) {
-    auto page_id = pages_[frame_id].page_id_;
-    FlushPg(page_id);
-    page_table_.erase(page_id);
-    pages_[frame_id].is_dirty_ = false;
+  auto is_clean = [this](frame_id_t frame_id) { return !pages_[frame_id].is_dirty_; };
+  victim_searches_.fetch_add(1, std::memory_order_relaxed);
+  while (replacer_->PreferredVictim(&frame_id, is_clean)) {
+    if (!ClaimFrame(frame_id)) {
+      // pinned since it entered the replacer (or being cleaned by the background writer); it goes back to the
+      // replacer with its last unpin
+      continue;
+    }
+    evict(frame_id);
+    SetFrameStrategy(frame_id, strategy);
     return frame_id;
   }
   return -1;
 }
 
-void BufferPoolManagerInstance::FlushPg(page_id_t page_id) {
-  auto frame_id = FindPg(page_id);
-  if (pages_[frame_id].IsDirty()) {
-    disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
+auto BufferPoolManagerInstance::RecycleRingFrame(AccessStrategy strategy) -> frame_id_t {
+  size_t capacity;
+  auto *ring = GetRing(strategy, &capacity);
+  for (auto itr = ring->begin(); itr != ring->end(); ++itr) {
+    frame_id_t frame_id = *itr;
+    if (ClaimFrame(frame_id)) {
+      ring->erase(itr);
+      frame_strategies_[frame_id] = AccessStrategy::NORMAL;
+      replacer_->Remove(frame_id);
+      return frame_id;
+    }
+  }
+  return -1;
+}
+
+void BufferPoolManagerInstance::SetFrameStrategy(frame_id_t frame_id, AccessStrategy strategy) {
+  size_t capacity;
+  if (frame_strategies_[frame_id] == strategy) {
+    return;
+  }
+  if (frame_strategies_[frame_id] != AccessStrategy::NORMAL) {
+    auto *ring = GetRing(frame_strategies_[frame_id], &capacity);
+    ring->erase(std::find(ring->begin(), ring->end(), frame_id));
+  }
+  frame_strategies_[frame_id] = strategy;
+  if (strategy == AccessStrategy::NORMAL) {
+    return;
+  }
+  auto *ring = GetRing(strategy, &capacity);
+  ring->push_back(frame_id);
+  while (ring->size() > capacity) {
+    // frames that fall off the ring stay in the replacer and age out like any other page
+    frame_strategies_[ring->front()] = AccessStrategy::NORMAL;
+    ring->pop_front();
+  }
+}
+
+void BufferPoolManagerInstance::AddFrames(size_t pool_size) {
+  for (size_t i = pool_size_; i < pool_size; ++i) {
+    if (i >= num_constructed_frames_) {
+      new (&pages_[i]) Page(arena_.GetFrameData(i));
+      num_constructed_frames_ = i + 1;
+    }
+    // free frames are claimed by the buffer pool
+    pages_[i].pin_count_ = -1;
+    frame_strategies_[i] = AccessStrategy::NORMAL;
+    free_list_.emplace_back(static_cast<frame_id_t>(i));
+  }
+  pool_size_ = std::max<size_t>(pool_size_, pool_size);
+}
+
+auto BufferPoolManagerInstance::WithdrawFrame(frame_id_t frame_id, size_t pool_size) -> bool {
+  Page *page = &pages_[frame_id];
+  page_id_t page_id = page->page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    free_list_.remove(frame_id);
+    return true;
+  }
+  if (page->io_in_progress_ || !ClaimFrame(frame_id)) {
+    return false;
+  }
+  if (page->is_dirty_) {
+    // dirtied again since it was written back
+    page->pin_count_ = 0;
+    return false;
+  }
+
+  UnswizzleFrame(frame_id);
+  page_table_.Erase(page_id);
+  replacer_->Remove(frame_id);
+  SetFrameStrategy(frame_id, AccessStrategy::NORMAL);
+  page->version_++;
+  auto target = std::find_if(free_list_.begin(), free_list_.end(), [pool_size](frame_id_t free_frame_id) {
+    return static_cast<size_t>(free_frame_id) < pool_size;
+  });
+  if (target != free_list_.end()) {
+    // nobody holds a pointer to an unpinned page (swizzled ones are gone), so it can move instead of being evicted
+    frame_id_t new_frame_id = *target;
+    free_list_.erase(target);
+    Page *new_page = &pages_[new_frame_id];
+    memcpy(new_page->GetData(), page->GetData(), PAGE_SIZE);
+    new_page->page_id_ = page_id;
+    new_page->pin_count_ = 0;
+    replacer_->Unpin(new_frame_id);
+    page_table_.Insert(page_id, new_frame_id);
+  }
+  page->page_id_ = INVALID_PAGE_ID;
+  page->version_.fetch_add(1, std::memory_order_release);
+  return true;
+}
+
+void BufferPoolManagerInstance::ReleaseFrames(size_t pool_size) {
+  // The descriptors stay: a lock-free hit that looked a withdrawn frame up just before finds it claimed.
+  arena_.Release(pool_size, pool_size_);
+  pool_size_ = pool_size;
+}
+
+auto BufferPoolManagerInstance::GetRing(AccessStrategy strategy, size_t *capacity) -> std::deque<frame_id_t> * {
+  // a ring never takes more than a quarter of the pool
+  size_t limit = std::max<size_t>(1, pool_size_ / 4);
+  if (strategy == AccessStrategy::SEQUENTIAL) {
+    *capacity = std::min<size_t>(SEQUENTIAL_RING_SIZE, limit);
+    return &sequential_ring_;
+  }
+  BUSTUB_ASSERT(strategy == AccessStrategy::BULK_WRITE, "NORMAL accesses have no ring");
+  *capacity = std::min<size_t>(BULK_WRITE_RING_SIZE, limit);
+  return &bulk_write_ring_;
+}
+
+auto BufferPoolManagerInstance::DoPgIo(frame_id_t frame_id, page_id_t victim_page_id, page_id_t read_page_id) -> bool {
+  if (victim_page_id != INVALID_PAGE_ID) {
+    disk_manager_->WritePage(victim_page_id, pages_[frame_id].GetData());
+    eviction_writes_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (read_page_id != INVALID_PAGE_ID) {
+    return disk_manager_->ReadPage(read_page_id, pages_[frame_id].GetData());
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::FinishPgIo(frame_id_t frame_id, page_id_t victim_page_id) {
+  pages_[frame_id].io_in_progress_ = false;
+  pages_[frame_id].version_.fetch_add(1, std::memory_order_release);
+  if (victim_page_id != INVALID_PAGE_ID) {
+    pages_in_writeback_.erase(victim_page_id);
+  }
+  io_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::AbortPgIo(frame_id_t frame_id, page_id_t victim_page_id) {
+  // lock-free pinners that found the frame drop their pin again as soon as they see io_in_progress_
+  int reserved = 1;
+  while (!pages_[frame_id].pin_count_.compare_exchange_weak(reserved, -1)) {
+    reserved = 1;
+    std::this_thread::yield();
+  }
+  RemoveFrame(frame_id);
+  FinishPgIo(frame_id, victim_page_id);
+}
+
+void BufferPoolManagerInstance::RunBackgroundWriter() {
+  std::unique_lock<TimedMutex> lock(latch_);
+  while (!stop_threads_) {
+    background_writer_cv_.wait_for(lock, background_writer_interval);
+
+    size_t num_dirty = 0;
+    std::vector<std::pair<page_id_t, frame_id_t>> candidates;
+    for (size_t i = 0; i < pool_size_; ++i) {
+      if (pages_[i].page_id_ == INVALID_PAGE_ID || !pages_[i].is_dirty_) {
+        continue;
+      }
+      num_dirty++;
+      if (pages_[i].pin_count_ == 0) {
+        candidates.emplace_back(pages_[i].page_id_, static_cast<frame_id_t>(i));
+      }
+    }
+    auto watermark = static_cast<size_t>(background_writer_dirty_ratio * pool_size_);
+    if (num_dirty == 0 || num_dirty < watermark) {
+      continue;
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    for (const auto &[page_id, frame_id] : candidates) {
+      if (stop_threads_ || num_dirty < watermark) {
+        break;
+      }
+      // the frame may have been evicted, pinned or cleaned while latch_ was released for the previous write
+      if (pages_[frame_id].page_id_ != page_id || pages_[frame_id].pin_count_ != 0 || !pages_[frame_id].is_dirty_ ||
+          pages_[frame_id].io_in_progress_) {
+        continue;
+      }
+      CleanPg(frame_id, &lock);
+      background_writes_.fetch_add(1, std::memory_order_relaxed);
+      num_dirty--;
+    }
+  }
+}
+
+void BufferPoolManagerInstance::CleanPg(frame_id_t frame_id, std::unique_lock<TimedMutex> *lock) {
+  Page *page = &pages_[frame_id];
+  page_id_t page_id = page->page_id_;
+  // pinned without telling the replacer, so the frame keeps its place there
+  page->pin_count_++;
+  // cleared before the write: anyone who modifies the page meanwhile marks it dirty again when unpinning
+  page->is_dirty_ = false;
+  num_cleaning_frames_++;
+  lock->unlock();
+
+  page->RLatch();
+  disk_manager_->WritePage(page_id, page->GetData());
+  page->RUnlatch();
+
+  lock->lock();
+  // a no-op for the replacer unless a miss skipped this frame while it was being written
+  UnpinFrame(frame_id);
+  num_cleaning_frames_--;
+  io_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::FlushBatch(const std::vector<std::pair<page_id_t, frame_id_t>> &batch) {
+  std::vector<page_id_t> page_ids;
+  std::vector<frame_id_t> frame_ids;
+  std::vector<page_id_t> evicted_page_ids;
+  {
+    std::lock_guard<TimedMutex> lg(latch_);
+    for (const auto &[page_id, frame_id] : batch) {
+      Page *page = &pages_[frame_id];
+      if (page->page_id_ != page_id || page->io_in_progress_ || page->pin_count_ < 0) {
+        // evicted (or being evicted) since: its evictor writes it back
+        evicted_page_ids.push_back(page_id);
+        continue;
+      }
+      if (!page->is_dirty_) {
+        continue;
+      }
+      // pinned without telling the replacer, as in CleanPg
+      page->pin_count_++;
+      page->is_dirty_ = false;
+      page_ids.push_back(page_id);
+      frame_ids.push_back(frame_id);
+    }
+    num_cleaning_frames_ += frame_ids.size();
+  }
+
+  // copy the pages out one at a time: holding several page latches at once could deadlock with their writers
+  std::vector<char> buffer(frame_ids.size() * PAGE_SIZE);
+  std::vector<const char *> page_data;
+  for (size_t i = 0; i < frame_ids.size(); ++i) {
+    Page *page = &pages_[frame_ids[i]];
+    page->RLatch();
+    memcpy(&buffer[i * PAGE_SIZE], page->GetData(), PAGE_SIZE);
+    page->RUnlatch();
+    page_data.push_back(&buffer[i * PAGE_SIZE]);
+  }
+  if (!page_ids.empty()) {
+    disk_manager_->WritePages(page_ids, page_data);
+  }
+
+  std::unique_lock<TimedMutex> lock(latch_);
+  for (auto frame_id : frame_ids) {
+    UnpinFrame(frame_id);
   }
+  num_cleaning_frames_ -= frame_ids.size();
+  io_cv_.notify_all();
+  io_cv_.wait(lock, [this, &evicted_page_ids] {
+    return std::none_of(evicted_page_ids.begin(), evicted_page_ids.end(),
+                        [this](page_id_t page_id) { return pages_in_writeback_.count(page_id) > 0; });
+  });
 }
 
 }  // namespace bustub
@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <sstream>
+
+namespace bustub {
+
+auto BufferPoolStats::operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+  pool_size_ += other.pool_size_;
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  prefetches_ += other.prefetches_;
+  evictions_ += other.evictions_;
+  eviction_writes_ += other.eviction_writes_;
+  background_writes_ += other.background_writes_;
+  latch_waits_ += other.latch_waits_;
+  latch_wait_ns_ += other.latch_wait_ns_;
+  victim_searches_ += other.victim_searches_;
+  victim_search_steps_ += other.victim_search_steps_;
+  return *this;
+}
+
+auto BufferPoolStats::ToString() const -> std::string {
+  std::ostringstream os;
+  os << "instance=" << instance_index_ << " pool_size=" << pool_size_ << " hits=" << hits_ << " misses=" << misses_
+     << " hit_ratio=" << HitRatio() << " prefetches=" << prefetches_ << " evictions=" << evictions_
+     << " eviction_writes=" << eviction_writes_ << " background_writes=" << background_writes_
+     << " latch_waits=" << latch_waits_ << " latch_wait_us=" << latch_wait_ns_ / 1000
+     << " victim_searches=" << victim_searches_ << " victim_search_steps=" << victim_search_steps_;
+  return os.str();
+}
+
+}  // namespace bustub
@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats_reporter.cpp
+//
+// Identification: src/buffer/buffer_pool_stats_reporter.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats_reporter.h"
+
+#include <utility>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+BufferPoolStatsReporter::BufferPoolStatsReporter(BufferPoolManager *buffer_pool_manager, report_fn report)
+    : buffer_pool_manager_(buffer_pool_manager), report_(std::move(report)) {
+  thread_ = std::thread(&BufferPoolStatsReporter::Run, this);
+}
+
+BufferPoolStatsReporter::~BufferPoolStatsReporter() {
+  {
+    std::lock_guard<std::mutex> lg(latch_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+void BufferPoolStatsReporter::Report() {
+  std::vector<BufferPoolStats> stats;
+  buffer_pool_manager_->GetStats(&stats);
+  report_(stats);
+}
+
+void BufferPoolStatsReporter::LogStats(const std::vector<BufferPoolStats> &stats) {
+  for (const auto &instance_stats : stats) {
+    LOG_INFO("buffer pool %s", instance_stats.ToString().c_str());
+  }
+}
+
+void BufferPoolStatsReporter::Run() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!cv_.wait_for(lock, buffer_pool_stats_interval, [this] { return stop_; })) {
+    lock.unlock();
+    Report();
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
@@ -14,16 +14,90 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : states_(num_pages) {
+  for (auto &state : states_) {
+    state.store(0, std::memory_order_relaxed);
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return Sweep(frame_id, nullptr); }
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+auto ClockReplacer::PreferredVictim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &is_preferred)
+    -> bool {
+  return Sweep(frame_id, &is_preferred);
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) { states_[frame_id].store(0, std::memory_order_release); }
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  states_[frame_id].store(IN_REPLACER | REFERENCED, std::memory_order_release);
+}
+
+void ClockReplacer::GetEvictionOrder(std::vector<frame_id_t> *frame_ids) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  frame_ids->clear();
+  const size_t num_frames = states_.size();
+  for (uint8_t referenced : {uint8_t{0}, REFERENCED}) {
+    for (size_t step = 0; step < num_frames; step++) {
+      size_t current = (hand_ + step) % num_frames;
+      uint8_t value = states_[current].load(std::memory_order_relaxed);
+      if ((value & IN_REPLACER) != 0 && (value & REFERENCED) == referenced) {
+        frame_ids->push_back(static_cast<frame_id_t>(current));
+      }
+    }
+  }
+}
+
+auto ClockReplacer::Size() -> size_t {
+  size_t size = 0;
+  for (const auto &state : states_) {
+    if ((state.load(std::memory_order_relaxed) & IN_REPLACER) != 0) {
+      size++;
+    }
+  }
+  return size;
+}
+
+auto ClockReplacer::Sweep(frame_id_t *frame_id, const std::function<bool(frame_id_t)> *is_preferred) -> bool {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  const size_t num_frames = states_.size();
+  // The first sweep clears reference bits, the second finds a victim among preferred frames. After that any frame
+  // goes. Give up once a whole sweep saw no frame in the replacer at all.
+  size_t steps = 0;
+  for (size_t sweep = 0;; sweep++) {
+    bool found_candidate = false;
+    for (size_t step = 0; step < num_frames; step++) {
+      steps++;
+      auto current = static_cast<frame_id_t>(hand_);
+      hand_ = (hand_ + 1) % num_frames;
+      auto &state = states_[current];
+      uint8_t value = state.load(std::memory_order_acquire);
+      if ((value & IN_REPLACER) == 0) {
+        continue;
+      }
+      found_candidate = true;
+      if ((value & REFERENCED) != 0) {
+        // a failed exchange means the frame was pinned or unpinned meanwhile; either way it is not a victim yet
+        state.compare_exchange_strong(value, IN_REPLACER, std::memory_order_acq_rel);
+        continue;
+      }
+      if (is_preferred != nullptr && sweep < 2 && !(*is_preferred)(current)) {
+        continue;
+      }
+      if (state.compare_exchange_strong(value, 0, std::memory_order_acq_rel)) {
+        victim_search_steps_.fetch_add(steps, std::memory_order_relaxed);
+        *frame_id = current;
+        return true;
+      }
+    }
+    if (!found_candidate) {
+      victim_search_steps_.fetch_add(steps, std::memory_order_relaxed);
+      *frame_id = INVALID_PAGE_ID;
+      return false;
+    }
+  }
+}
 
 }  // namespace bustub
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.cpp
+//
+// Identification: src/buffer/extent_allocator.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/extent_allocator.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ExtentAllocator::ExtentAllocator(FreeSpaceMap *free_space_map, const PageRouter *router, uint32_t instance_index)
+    : free_space_map_(free_space_map), router_(router), instance_index_(instance_index) {
+  page_id_t end = free_space_map_->GetEnd();
+  for (page_id_t page_id = 0; page_id < end; page_id++) {
+    if (router_->GetInstance(page_id) != instance_index_ || !free_space_map_->IsAllocated(page_id)) {
+      continue;
+    }
+    auto extent = static_cast<size_t>(router_->GetLocalIndex(page_id) / EXTENT_SIZE);
+    if (extent >= extent_used_.size()) {
+      extent_used_.resize(extent + 1, 0);
+    }
+    extent_used_[extent]++;
+  }
+}
+
+auto ExtentAllocator::IsAllocated(page_id_t local_index) const -> bool {
+  return free_space_map_->IsAllocated(router_->GetPageId(instance_index_, local_index));
+}
+
+void ExtentAllocator::Take(page_id_t local_index) {
+  free_space_map_->SetAllocated(router_->GetPageId(instance_index_, local_index), true);
+  auto extent = static_cast<size_t>(local_index / EXTENT_SIZE);
+  if (extent >= extent_used_.size()) {
+    extent_used_.resize(extent + 1, 0);
+  }
+  extent_used_[extent]++;
+}
+
+auto ExtentAllocator::Allocate(page_id_t near_page_id, bool *new_extent) -> page_id_t {
+  page_id_t local_index = -1;
+  if (near_page_id != INVALID_PAGE_ID && router_->GetInstance(near_page_id) == instance_index_) {
+    // the free page after near_page_id in its extent, or else the first one before it
+    page_id_t near_index = router_->GetLocalIndex(near_page_id);
+    page_id_t extent_start = near_index / EXTENT_SIZE * EXTENT_SIZE;
+    for (page_id_t i = 1; i < EXTENT_SIZE && local_index == -1; i++) {
+      page_id_t candidate = extent_start + (near_index - extent_start + i) % EXTENT_SIZE;
+      if (!IsAllocated(candidate)) {
+        local_index = candidate;
+      }
+    }
+    if (local_index == -1) {
+      // the extent is full: start an empty one
+      auto extent = std::find(extent_used_.begin(), extent_used_.end(), 0) - extent_used_.begin();
+      local_index = static_cast<page_id_t>(extent) * EXTENT_SIZE;
+    }
+  } else {
+    while (IsAllocated(first_free_)) {
+      first_free_++;
+    }
+    local_index = first_free_;
+  }
+
+  auto extent = static_cast<size_t>(local_index / EXTENT_SIZE);
+  *new_extent = extent >= extent_used_.size() || extent_used_[extent] == 0;
+  Take(local_index);
+  if (local_index == first_free_) {
+    first_free_++;
+  }
+  return router_->GetPageId(instance_index_, local_index);
+}
+
+void ExtentAllocator::Free(page_id_t page_id) {
+  if (!free_space_map_->SetAllocated(page_id, false)) {
+    return;
+  }
+  page_id_t local_index = router_->GetLocalIndex(page_id);
+  extent_used_[local_index / EXTENT_SIZE]--;
+  first_free_ = std::min(first_free_, local_index);
+}
+
+void ExtentAllocator::GetExtentRange(page_id_t page_id, page_id_t *first_page_id, page_id_t *end_page_id) const {
+  page_id_t extent_start = router_->GetLocalIndex(page_id) / EXTENT_SIZE * EXTENT_SIZE;
+  *first_page_id = router_->GetPageId(instance_index_, extent_start);
+  *end_page_id = router_->GetPageId(instance_index_, extent_start + EXTENT_SIZE - 1) + 1;
+}
+
+}  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+auto RoundUp(uintptr_t value, uintptr_t alignment) -> uintptr_t {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+auto RoundDown(uintptr_t value, uintptr_t alignment) -> uintptr_t { return value / alignment * alignment; }
+
+void PlaceOnNode(void *addr, size_t length, int numa_node) {
+  if (numa_node < 0 || numa_node >= static_cast<int>(8 * sizeof(unsigned long))) {  // NOLINT
+    return;
+  }
+  unsigned long node_mask = 1UL << numa_node;  // NOLINT
+  // preferred rather than bound: when the node runs out of memory, the pool spills to another node instead of failing
+  // the allocation. Errors (no NUMA support, seccomp) just leave the default policy in place.
+  syscall(SYS_mbind, addr, length, MPOL_PREFERRED, &node_mask, 8 * sizeof(node_mask), 0);
+}
+
+}  // namespace
+
+FrameArena::FrameArena(size_t num_frames, size_t descriptor_size, int numa_node) {
+  size_t data_size = RoundUp(num_frames * PAGE_SIZE, HUGE_PAGE_SIZE);
+  // Not MAP_NORESERVE: the mapping has to fail right away (rather than fault later) if not enough huge pages are free.
+  data_mapping_ = mmap(nullptr, data_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  huge_pages_ = data_mapping_ != MAP_FAILED;
+  if (huge_pages_) {
+    data_mapping_size_ = data_size;
+    data_ = static_cast<char *>(data_mapping_);
+  } else {
+    // over-reserve so the data can start on a huge page boundary, which transparent huge pages need
+    data_mapping_size_ = data_size + HUGE_PAGE_SIZE;
+    data_mapping_ = mmap(nullptr, data_mapping_size_, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (data_mapping_ == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't reserve the buffer pool");
+    }
+    data_ = reinterpret_cast<char *>(RoundUp(reinterpret_cast<uintptr_t>(data_mapping_), HUGE_PAGE_SIZE));
+    madvise(data_, data_size, MADV_HUGEPAGE);
+  }
+
+  descriptors_size_ = num_frames * descriptor_size;
+  descriptors_ = mmap(nullptr, descriptors_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                      -1, 0);
+  if (descriptors_ == MAP_FAILED) {
+    munmap(data_mapping_, data_mapping_size_);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't reserve the buffer pool");
+  }
+
+  PlaceOnNode(data_, data_size, numa_node);
+  PlaceOnNode(descriptors_, descriptors_size_, numa_node);
+}
+
+FrameArena::~FrameArena() {
+  munmap(data_mapping_, data_mapping_size_);
+  munmap(descriptors_, descriptors_size_);
+}
+
+void FrameArena::Release(size_t begin, size_t end) {
+  // only whole (huge) pages can go; a partial one is still shared with a frame outside the range
+  uintptr_t granularity = huge_pages_ ? HUGE_PAGE_SIZE : static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  uintptr_t release_begin = RoundUp(reinterpret_cast<uintptr_t>(GetFrameData(begin)), granularity);
+  uintptr_t release_end = RoundDown(reinterpret_cast<uintptr_t>(GetFrameData(end)), granularity);
+  if (release_begin < release_end) {
+    madvise(reinterpret_cast<void *>(release_begin), release_end - release_begin, MADV_DONTNEED);
+  }
+}
+
+auto FrameArena::NumNumaNodes() -> int {
+  // e.g. "0" or "0-1"; the nodes are numbered densely from 0
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string nodes;
+  if (!(online >> nodes)) {
+    return 1;
+  }
+  auto last = nodes.find_last_of("-,");
+  return std::stoi(last == std::string::npos ? nodes : nodes.substr(last + 1)) + 1;
+}
+
+}  // namespace bustub
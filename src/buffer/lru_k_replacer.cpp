@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, size_t correlated_period)
+    : k_(k), correlated_period_(correlated_period), frames_(num_pages) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs k >= 1");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+auto LRUKReplacer::Victim(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  if (evictable_frames_.empty()) {
+    *frame_id = INVALID_PAGE_ID;
+    return false;
+  }
+
+  victim_search_steps_.fetch_add(1, std::memory_order_relaxed);
+  *frame_id = std::get<2>(*evictable_frames_.begin());
+  evictable_frames_.erase(evictable_frames_.begin());
+  frames_[*frame_id] = FrameHistory{};
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  if (frames_[frame_id].evictable_) {
+    evictable_frames_.erase(GetEvictionKey(frame_id));
+    frames_[frame_id].evictable_ = false;
+  }
+  RecordAccess(frame_id);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  auto &frame = frames_[frame_id];
+  if (frame.evictable_) {
+    return;
+  }
+  // a frame that was never pinned through the replacer still needs a first access to be ordered by
+  if (frame.history_.empty()) {
+    RecordAccess(frame_id);
+  }
+  frame.evictable_ = true;
+  evictable_frames_.insert(GetEvictionKey(frame_id));
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  if (frames_[frame_id].evictable_) {
+    evictable_frames_.erase(GetEvictionKey(frame_id));
+  }
+  frames_[frame_id] = FrameHistory{};
+}
+
+void LRUKReplacer::GetEvictionOrder(std::vector<frame_id_t> *frame_ids) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  frame_ids->clear();
+  for (const auto &key : evictable_frames_) {
+    frame_ids->push_back(std::get<2>(key));
+  }
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  return evictable_frames_.size();
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  auto &frame = frames_[frame_id];
+  uint64_t now = ++current_timestamp_;
+  bool correlated = !frame.history_.empty() && now - frame.last_access_ <= correlated_period_;
+  frame.last_access_ = now;
+  if (correlated) {
+    return;
+  }
+  frame.history_.push_back(now);
+  if (frame.history_.size() > k_) {
+    frame.history_.pop_front();
+  }
+}
+
+auto LRUKReplacer::GetEvictionKey(frame_id_t frame_id) const -> EvictionKey {
+  // history_.front() is the k-th most recent access for a full history, the first access otherwise
+  const auto &history = frames_[frame_id].history_;
+  return {history.size() >= k_, history.front(), frame_id};
+}
+
+}  // namespace bustub
@@ -25,6 +25,7 @@ auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool {
     return false;
   }
 
+  victim_search_steps_.fetch_add(1, std::memory_order_relaxed);
   *frame_id = replace_frames_.back();
   replace_frames_.pop_back();
   replace_map_.erase(*frame_id);
@@ -32,6 +33,37 @@ auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool {
   return true;
 }
 
+auto LRUReplacer::PreferredVictim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &is_preferred)
+    -> bool {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  if (replace_frames_.empty()) {
+    *frame_id = INVALID_PAGE_ID;
+    return false;
+  }
+
+  // only look at the oldest quarter so that a pool full of dirty frames does not turn every miss into a full scan
+  size_t window = replace_frames_.size() / 4 + 1;
+  size_t steps = 0;
+  auto victim = std::prev(replace_frames_.end());
+  for (auto itr = victim; window > 0; --itr, --window) {
+    steps++;
+    if (is_preferred(*itr)) {
+      victim = itr;
+      break;
+    }
+    if (itr == replace_frames_.begin()) {
+      break;
+    }
+  }
+  victim_search_steps_.fetch_add(steps, std::memory_order_relaxed);
+
+  *frame_id = *victim;
+  replace_frames_.erase(victim);
+  replace_map_.erase(*frame_id);
+  size_--;
+  return true;
+}
+
 void LRUReplacer::Pin(frame_id_t frame_id) {
   std::lock_guard<std::mutex> lock_guard(latch_);
   if (replace_map_.find(frame_id) == replace_map_.end()) {
@@ -54,6 +86,11 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
   replace_map_[frame_id] = replace_frames_.begin();
 }
 
+void LRUReplacer::GetEvictionOrder(std::vector<frame_id_t> *frame_ids) {
+  std::lock_guard<std::mutex> lock_guard(latch_);
+  frame_ids->assign(replace_frames_.rbegin(), replace_frames_.rend());
+}
+
 auto LRUReplacer::Size() -> size_t { return this->size_; }
 
 }  // namespace bustub
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_pressure_controller.cpp
+//
+// Identification: src/buffer/memory_pressure_controller.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/memory_pressure_controller.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+
+namespace bustub {
+
+MemoryPressureController::MemoryPressureController(BufferPoolManager *buffer_pool_manager, size_t min_pool_size,
+                                                   size_t max_pool_size, size_t low_watermark, size_t high_watermark,
+                                                   std::function<size_t()> available_memory)
+    : buffer_pool_manager_(buffer_pool_manager),
+      min_pool_size_(min_pool_size),
+      max_pool_size_(std::max(min_pool_size, max_pool_size)),
+      low_watermark_(low_watermark),
+      high_watermark_(std::max(low_watermark, high_watermark)),
+      available_memory_(std::move(available_memory)) {
+  thread_ = std::thread(&MemoryPressureController::Run, this);
+}
+
+MemoryPressureController::~MemoryPressureController() {
+  {
+    std::lock_guard<std::mutex> lg(latch_);
+    stop_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+}
+
+auto MemoryPressureController::Adjust() -> size_t {
+  const size_t chunk_bytes = static_cast<size_t>(BUFFER_POOL_CHUNK_SIZE) * PAGE_SIZE;
+  size_t available = available_memory_();
+  size_t pool_size = buffer_pool_manager_->GetPoolSize();
+  size_t target = pool_size;
+  if (available < low_watermark_) {
+    size_t chunks = (low_watermark_ - available + chunk_bytes - 1) / chunk_bytes;
+    size_t frames = chunks * BUFFER_POOL_CHUNK_SIZE;
+    target = pool_size > frames ? pool_size - frames : 0;
+  } else if (available > high_watermark_ && available - high_watermark_ >= chunk_bytes) {
+    target = pool_size + BUFFER_POOL_CHUNK_SIZE;
+  }
+  target = std::clamp(target, min_pool_size_, max_pool_size_);
+  if (target == pool_size) {
+    return pool_size;
+  }
+  return buffer_pool_manager_->ResizePool(target);
+}
+
+auto MemoryPressureController::ReadAvailableMemory() -> size_t {
+  std::ifstream meminfo("/proc/meminfo");
+  std::string key;
+  size_t value;
+  std::string unit;
+  while (meminfo >> key >> value) {
+    std::getline(meminfo, unit);
+    if (key == "MemAvailable:") {
+      // reported in kB
+      return value * 1024;
+    }
+  }
+  return SIZE_MAX;
+}
+
+void MemoryPressureController::Run() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!stop_) {
+    cv_.wait_for(lock, memory_pressure_interval);
+    if (stop_) {
+      break;
+    }
+    lock.unlock();
+    Adjust();
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
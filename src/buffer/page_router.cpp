@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_router.cpp
+//
+// Identification: src/buffer/page_router.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_router.h"
+
+namespace bustub {
+
+auto PageRouter::Create(RoutingType routing_type, uint32_t num_instances) -> std::unique_ptr<PageRouter> {
+  switch (routing_type) {
+    case RoutingType::EXTENT:
+      return std::make_unique<ExtentPageRouter>(num_instances);
+    case RoutingType::MODULO:
+    default:
+      return std::make_unique<ModuloPageRouter>(num_instances);
+  }
+}
+
+auto ModuloPageRouter::GetInstance(page_id_t page_id) const -> uint32_t {
+  return static_cast<uint32_t>(page_id) % num_instances_;
+}
+
+auto ModuloPageRouter::GetLocalIndex(page_id_t page_id) const -> page_id_t {
+  return page_id / static_cast<page_id_t>(num_instances_);
+}
+
+auto ModuloPageRouter::GetPageId(uint32_t instance_index, page_id_t local_index) const -> page_id_t {
+  return local_index * static_cast<page_id_t>(num_instances_) + static_cast<page_id_t>(instance_index);
+}
+
+auto ExtentPageRouter::GetInstance(page_id_t page_id) const -> uint32_t {
+  return static_cast<uint32_t>(page_id / EXTENT_SIZE) % num_instances_;
+}
+
+auto ExtentPageRouter::GetLocalIndex(page_id_t page_id) const -> page_id_t {
+  page_id_t extent = page_id / EXTENT_SIZE / static_cast<page_id_t>(num_instances_);
+  return extent * EXTENT_SIZE + page_id % EXTENT_SIZE;
+}
+
+auto ExtentPageRouter::GetPageId(uint32_t instance_index, page_id_t local_index) const -> page_id_t {
+  page_id_t extent = local_index / EXTENT_SIZE * static_cast<page_id_t>(num_instances_) +
+                     static_cast<page_id_t>(instance_index);
+  return extent * EXTENT_SIZE + local_index % EXTENT_SIZE;
+}
+
+}  // namespace bustub
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) {
+  size_t num_slots = 2;
+  while (num_slots < 2 * num_frames) {
+    num_slots *= 2;
+  }
+  mask_ = num_slots - 1;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(num_slots);
+  for (size_t i = 0; i < num_slots; ++i) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+auto PageTable::HomeSlot(page_id_t page_id) const -> size_t {
+  // Fibonacci hashing: page ids of one instance are an arithmetic sequence, which this spreads evenly
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> 32) &
+         mask_;
+}
+
+auto PageTable::Find(page_id_t page_id) const -> frame_id_t {
+  for (size_t i = HomeSlot(page_id), probes = 0; probes <= mask_; i = (i + 1) & mask_, ++probes) {
+    uint64_t slot = slots_[i].load(std::memory_order_acquire);
+    if (slot == EMPTY_SLOT) {
+      return -1;
+    }
+    if (SlotPageId(slot) == page_id) {
+      return SlotFrameId(slot);
+    }
+  }
+  return -1;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  size_t i = HomeSlot(page_id);
+  uint64_t slot;
+  while ((slot = slots_[i].load(std::memory_order_relaxed)) != EMPTY_SLOT) {
+    // lookups would find the older frame first
+    BUSTUB_ASSERT(SlotPageId(slot) != page_id, "page is already in the page table");
+    i = (i + 1) & mask_;
+  }
+  slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+}
+
+void PageTable::Erase(page_id_t page_id) {
+  size_t hole = HomeSlot(page_id);
+  while (true) {
+    uint64_t slot = slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      return;
+    }
+    if (SlotPageId(slot) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask_;
+  }
+
+  // Move every later entry of the run whose probe sequence passes the hole back into it (Knuth's algorithm R), so a
+  // lookup can keep stopping at the first empty slot.
+  for (size_t i = (hole + 1) & mask_;; i = (i + 1) & mask_) {
+    uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    size_t home = HomeSlot(SlotPageId(slot));
+    bool home_after_hole = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+    if (home_after_hole) {
+      continue;
+    }
+    slots_[hole].store(slot, std::memory_order_release);
+    hole = i;
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+}
+
+}  // namespace bustub
@@ -12,15 +12,35 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
 namespace bustub {
 
+namespace {
+/** Tells the pools apart, even one created where a destroyed one used to be. */
+std::atomic<uint64_t> next_pool_id{0};
+
+/** Where the calling thread creates new pages. */
+struct HomeInstance {
+  /** The pool this is for; a thread moving to another pool is given a new home there. */
+  uint64_t pool_id_{UINT64_MAX};
+  uint32_t instance_index_{0};
+  /** Number of pages the thread created in its current home instance. */
+  uint32_t allocations_{0};
+};
+thread_local HomeInstance home;
+}  // namespace
+
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : bpmis_{num_instances}, pool_size_(pool_size) {
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     size_t max_pool_size, RoutingType routing_type)
+    : pool_id_(next_pool_id++), router_(PageRouter::Create(routing_type, num_instances)), bpmis_{num_instances} {
   // Allocate and create individual BufferPoolManagerInstances
   for (uint32_t instance_index = 0; instance_index < num_instances; instance_index++) {
-    bpmis_[instance_index] =
-        new BufferPoolManagerInstance(pool_size, num_instances, instance_index, disk_manager, log_manager);
+    bpmis_[instance_index] = new BufferPoolManagerInstance(pool_size, num_instances, instance_index, disk_manager,
+                                                           log_manager, replacer_type, max_pool_size, router_.get());
   }
 }
 
@@ -33,12 +53,16 @@ ParallelBufferPoolManager::~ParallelBufferPoolManager() {
 
 auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
   // Get size of all BufferPoolManagerInstances
-  return bpmis_.size() * pool_size_;
+  size_t pool_size = 0;
+  for (auto &bpmi : bpmis_) {
+    pool_size += bpmi->GetPoolSize();
+  }
+  return pool_size;
 }
 
 auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager * {
   // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
-  return bpmis_[page_id % bpmis_.size()];
+  return bpmis_[router_->GetInstance(page_id)];
 }
 
 auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
@@ -46,36 +70,130 @@ auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
   return GetBufferPoolManager(page_id)->FetchPage(page_id);
 }
 
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id, AccessStrategy strategy) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, strategy);
+}
+
+auto ParallelBufferPoolManager::FetchScanPgImp(page_id_t page_id, ScanHandle *scan) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchScanPage(page_id, scan);
+}
+
+auto ParallelBufferPoolManager::OptimisticFetchPgImp(page_id_t page_id, uint64_t *version) -> Page * {
+  return GetBufferPoolManager(page_id)->OptimisticFetchPage(page_id, version);
+}
+
+auto ParallelBufferPoolManager::FetchSwizzledPgImp(Page *page, page_id_t page_id) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchSwizzledPage(page, page_id);
+}
+
+auto ParallelBufferPoolManager::SwizzlePgImp(Page *page, SwizzleOwner *owner) -> bool {
+  return GetBufferPoolManager(page->GetPageId())->SwizzlePage(page, owner);
+}
+
+void ParallelBufferPoolManager::UnswizzleAllImp(SwizzleOwner *owner) {
+  for (auto &bpmi : bpmis_) {
+    bpmi->UnswizzleAll(owner);
+  }
+}
+
 auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
   // Unpin page_id from responsible BufferPoolManagerInstance
   return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
 }
 
+auto ParallelBufferPoolManager::GroupByInstance(const std::vector<page_id_t> &page_ids)
+    -> std::vector<std::vector<size_t>> {
+  std::vector<std::vector<size_t>> groups(bpmis_.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    groups[router_->GetInstance(page_ids[i])].push_back(i);
+  }
+  return groups;
+}
+
+void ParallelBufferPoolManager::FetchPgsImp(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages,
+                                            AccessStrategy strategy) {
+  pages->assign(page_ids.size(), nullptr);
+  auto groups = GroupByInstance(page_ids);
+  std::vector<page_id_t> group_page_ids;
+  std::vector<Page *> group_pages;
+  for (size_t instance = 0; instance < bpmis_.size(); ++instance) {
+    if (groups[instance].empty()) {
+      continue;
+    }
+    group_page_ids.clear();
+    for (auto i : groups[instance]) {
+      group_page_ids.push_back(page_ids[i]);
+    }
+    bpmis_[instance]->FetchPages(group_page_ids, &group_pages, strategy);
+    for (size_t j = 0; j < groups[instance].size(); ++j) {
+      (*pages)[groups[instance][j]] = group_pages[j];
+    }
+  }
+}
+
+auto ParallelBufferPoolManager::UnpinPgsImp(const std::vector<page_id_t> &page_ids, bool is_dirty) -> bool {
+  auto groups = GroupByInstance(page_ids);
+  std::vector<page_id_t> group_page_ids;
+  bool unpinned = true;
+  for (size_t instance = 0; instance < bpmis_.size(); ++instance) {
+    if (groups[instance].empty()) {
+      continue;
+    }
+    group_page_ids.clear();
+    for (auto i : groups[instance]) {
+      group_page_ids.push_back(page_ids[i]);
+    }
+    unpinned = bpmis_[instance]->UnpinPages(group_page_ids, is_dirty) && unpinned;
+  }
+  return unpinned;
+}
+
 auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
   // Flush page_id from responsible BufferPoolManagerInstance
   return GetBufferPoolManager(page_id)->FlushPage(page_id);
 }
 
 auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
-  // create new page. We will request page allocation in a round robin manner from the underlying
-  // BufferPoolManagerInstances
-  // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
-  // starting index and return nullptr
-  // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
-  // is called
-  uint32_t start_index = last_alloc_index_;
-  do {
-    auto page = bpmis_[start_index % bpmis_.size()]->NewPage(page_id);
+  const auto num_instances = static_cast<uint32_t>(bpmis_.size());
+  if (home.pool_id_ != pool_id_) {
+    // spread the threads over the instances
+    home = {pool_id_, next_home_index_++ % num_instances, 0};
+  } else if (home.allocations_ >= static_cast<uint32_t>(EXTENT_SIZE)) {
+    // move on after an extent, so that a thread creating many pages uses the whole pool
+    home.instance_index_ = (home.instance_index_ + 1) % num_instances;
+    home.allocations_ = 0;
+  }
+  // An instance with a free frame, the home instance first, beats evicting a page from the home instance
+  for (bool free_frames_only : {true, false}) {
+    for (uint32_t i = 0; i < num_instances; i++) {
+      uint32_t instance_index = (home.instance_index_ + i) % num_instances;
+      if (free_frames_only && !bpmis_[instance_index]->HasFreeFrame()) {
+        continue;
+      }
+      auto page = bpmis_[instance_index]->NewPage(page_id);
+      if (page != nullptr) {
+        if (i != 0) {
+          // the home instance had no frame to spare: the one that had becomes the new home
+          home.instance_index_ = instance_index;
+          home.allocations_ = 0;
+        }
+        home.allocations_++;
+        return page;
+      }
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::NewPgNearImp(page_id_t near_page_id, page_id_t *page_id) -> Page * {
+  if (near_page_id != INVALID_PAGE_ID) {
+    // only the instance owning near_page_id can place the page next to it
+    auto page = GetBufferPoolManager(near_page_id)->NewPageNear(near_page_id, page_id);
     if (page != nullptr) {
-      last_alloc_index_++;
-      last_alloc_index_ %= bpmis_.size();
       return page;
     }
-    start_index++;
-    start_index %= bpmis_.size();
-  } while (start_index != last_alloc_index_);
-  last_alloc_index_ = (last_alloc_index_ + 1) % bpmis_.size();
-  return nullptr;
+  }
+  return NewPgImp(page_id);
 }
 
 auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
@@ -90,4 +208,53 @@ void ParallelBufferPoolManager::FlushAllPgsImp() {
   }
 }
 
+auto ParallelBufferPoolManager::ResizePoolImp(size_t pool_size) -> size_t {
+  size_t num_instances = bpmis_.size();
+  size_t resized_pool_size = 0;
+  for (size_t i = 0; i < num_instances; ++i) {
+    resized_pool_size += bpmis_[i]->ResizePool(pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0));
+  }
+  return resized_pool_size;
+}
+
+void ParallelBufferPoolManager::GetResidentPgsImp(std::vector<page_id_t> *page_ids) {
+  std::vector<std::vector<page_id_t>> instance_page_ids(bpmis_.size());
+  size_t longest = 0;
+  for (size_t instance = 0; instance < bpmis_.size(); ++instance) {
+    bpmis_[instance]->GetResidentPages(&instance_page_ids[instance]);
+    longest = std::max(longest, instance_page_ids[instance].size());
+  }
+  page_ids->clear();
+  for (size_t rank = 0; rank < longest; ++rank) {
+    for (const auto &ids : instance_page_ids) {
+      if (rank < ids.size()) {
+        page_ids->push_back(ids[rank]);
+      }
+    }
+  }
+}
+
+auto ParallelBufferPoolManager::PrefetchPgsImp(const std::vector<page_id_t> &page_ids) -> size_t {
+  auto groups = GroupByInstance(page_ids);
+  std::vector<page_id_t> group_page_ids;
+  size_t num_read = 0;
+  for (size_t instance = 0; instance < bpmis_.size(); ++instance) {
+    group_page_ids.clear();
+    for (auto i : groups[instance]) {
+      group_page_ids.push_back(page_ids[i]);
+    }
+    num_read += bpmis_[instance]->PrefetchPages(group_page_ids);
+  }
+  return num_read;
+}
+
+void ParallelBufferPoolManager::GetStatsImp(std::vector<BufferPoolStats> *stats) {
+  stats->clear();
+  std::vector<BufferPoolStats> instance_stats;
+  for (auto &bpmi : bpmis_) {
+    bpmi->GetStats(&instance_stats);
+    stats->insert(stats->end(), instance_stats.begin(), instance_stats.end());
+  }
+}
+
 }  // namespace bustub
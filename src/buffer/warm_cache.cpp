@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// warm_cache.cpp
+//
+// Identification: src/buffer/warm_cache.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/warm_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+WarmCache::WarmCache(BufferPoolManager *buffer_pool_manager, std::string file_name)
+    : buffer_pool_manager_(buffer_pool_manager), file_name_(std::move(file_name)) {
+  loader_ = std::thread(&WarmCache::Load, this);
+  dumper_ = std::thread(&WarmCache::RunDump, this);
+}
+
+WarmCache::~WarmCache() {
+  bool loaded;
+  {
+    std::lock_guard<std::mutex> lg(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  loader_.join();
+  dumper_.join();
+  {
+    std::lock_guard<std::mutex> lg(latch_);
+    loaded = loaded_;
+  }
+  // a pool that was still warming up would overwrite a better list
+  if (loaded) {
+    Dump();
+  }
+}
+
+auto WarmCache::Dump() -> bool {
+  std::vector<page_id_t> page_ids;
+  buffer_pool_manager_->GetResidentPages(&page_ids);
+  std::string tmp_file_name = file_name_ + ".tmp";
+  {
+    std::ofstream file(tmp_file_name, std::ios::binary | std::ios::trunc);
+    auto num_pages = static_cast<uint32_t>(page_ids.size());
+    file.write(reinterpret_cast<const char *>(&WARM_CACHE_MAGIC), sizeof(WARM_CACHE_MAGIC));
+    file.write(reinterpret_cast<const char *>(&num_pages), sizeof(num_pages));
+    file.write(reinterpret_cast<const char *>(page_ids.data()), page_ids.size() * sizeof(page_id_t));
+    if (!file.good()) {
+      LOG_DEBUG("can't write warm cache file %s", tmp_file_name.c_str());
+      return false;
+    }
+  }
+  return std::rename(tmp_file_name.c_str(), file_name_.c_str()) == 0;
+}
+
+auto WarmCache::WaitForLoad() -> size_t {
+  std::unique_lock<std::mutex> lock(latch_);
+  cv_.wait(lock, [this] { return loaded_; });
+  return num_loaded_;
+}
+
+auto WarmCache::ReadFile(const std::string &file_name, std::vector<page_id_t> *page_ids) -> bool {
+  std::ifstream file(file_name, std::ios::binary);
+  uint32_t magic = 0;
+  uint32_t num_pages = 0;
+  file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  file.read(reinterpret_cast<char *>(&num_pages), sizeof(num_pages));
+  if (!file.good() || magic != WARM_CACHE_MAGIC) {
+    return false;
+  }
+  page_ids->resize(num_pages);
+  file.read(reinterpret_cast<char *>(page_ids->data()), num_pages * sizeof(page_id_t));
+  if (!file.good()) {
+    page_ids->clear();
+    return false;
+  }
+  return true;
+}
+
+void WarmCache::Load() {
+  std::vector<page_id_t> page_ids;
+  size_t num_loaded = 0;
+  if (ReadFile(file_name_, &page_ids)) {
+    // the hottest pages that fit, read in disk order
+    page_ids.resize(std::min(page_ids.size(), buffer_pool_manager_->GetPoolSize()));
+    std::sort(page_ids.begin(), page_ids.end());
+    std::vector<page_id_t> batch;
+    for (size_t begin = 0; begin < page_ids.size(); begin += BUFFER_POOL_CHUNK_SIZE) {
+      {
+        std::lock_guard<std::mutex> lg(latch_);
+        if (stop_) {
+          break;
+        }
+      }
+      size_t end = std::min<size_t>(begin + BUFFER_POOL_CHUNK_SIZE, page_ids.size());
+      batch.assign(page_ids.begin() + begin, page_ids.begin() + end);
+      num_loaded += buffer_pool_manager_->PrefetchPages(batch);
+    }
+  }
+
+  std::lock_guard<std::mutex> lg(latch_);
+  loaded_ = !stop_;
+  num_loaded_ = num_loaded;
+  cv_.notify_all();
+}
+
+void WarmCache::RunDump() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!cv_.wait_for(lock, warm_cache_dump_interval, [this] { return stop_; })) {
+    if (!loaded_) {
+      continue;
+    }
+    lock.unlock();
+    Dump();
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
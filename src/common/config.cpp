@@ -20,4 +20,14 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds background_writer_interval = std::chrono::milliseconds(50);
+
+std::atomic<double> background_writer_dirty_ratio(0.25);
+
+std::chrono::milliseconds memory_pressure_interval = std::chrono::milliseconds(1000);
+
+std::chrono::milliseconds warm_cache_dump_interval = std::chrono::milliseconds(60000);
+
+std::chrono::milliseconds buffer_pool_stats_interval = std::chrono::milliseconds(10000);
+
 }  // namespace bustub
@@ -0,0 +1,166 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.cpp
+//
+// Identification: src/common/util/crc32c.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+/** The CRC-32C polynomial, bit-reversed. */
+constexpr uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+/** Table k holds the checksum of a byte followed by k zero bytes, to fold 8 bytes at a time. */
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+auto MakeTables() -> CrcTables {
+  CrcTables tables{};
+  for (uint32_t byte = 0; byte < 256; byte++) {
+    uint32_t crc = byte;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLYNOMIAL : 0);
+    }
+    tables[0][byte] = crc;
+  }
+  for (uint32_t byte = 0; byte < 256; byte++) {
+    for (size_t k = 1; k < tables.size(); k++) {
+      uint32_t prev = tables[k - 1][byte];
+      tables[k][byte] = (prev >> 8) ^ tables[0][prev & 0xFF];
+    }
+  }
+  return tables;
+}
+
+auto GetTables() -> const CrcTables & {
+  static const CrcTables tables = MakeTables();
+  return tables;
+}
+
+#if defined(__x86_64__)
+/**
+ * The crc32 instruction takes three cycles but can start one every cycle, so long buffers are checksummed as three
+ * interleaved streams over blocks of this many bytes, three of which cover all but the last 16 bytes of a page.
+ */
+constexpr size_t SSE42_BLOCK_SIZE = 1360;
+
+/** Table k maps byte k of a checksum to its part in the checksum after SSE42_BLOCK_SIZE more zero bytes. */
+using ShiftTables = std::array<std::array<uint32_t, 256>, 4>;
+
+auto MakeShiftTables() -> ShiftTables {
+  const auto &tables = GetTables();
+  // appending zeros is linear in the checksum: shift each bit, then combine the bits of every byte value
+  std::array<uint32_t, 32> shifted_bits;
+  for (int bit = 0; bit < 32; bit++) {
+    uint32_t crc = uint32_t{1} << bit;
+    for (size_t i = 0; i < SSE42_BLOCK_SIZE; i++) {
+      crc = (crc >> 8) ^ tables[0][crc & 0xFF];
+    }
+    shifted_bits[bit] = crc;
+  }
+  ShiftTables shift_tables{};
+  for (size_t k = 0; k < shift_tables.size(); k++) {
+    for (uint32_t byte = 0; byte < 256; byte++) {
+      for (int bit = 0; bit < 8; bit++) {
+        if ((byte & (1U << bit)) != 0) {
+          shift_tables[k][byte] ^= shifted_bits[8 * k + bit];
+        }
+      }
+    }
+  }
+  return shift_tables;
+}
+
+/** @return the checksum of the bytes so far after SSE42_BLOCK_SIZE more zero bytes */
+auto ShiftBlock(uint32_t crc) -> uint32_t {
+  static const ShiftTables shift_tables = MakeShiftTables();
+  return shift_tables[0][crc & 0xFF] ^ shift_tables[1][(crc >> 8) & 0xFF] ^ shift_tables[2][(crc >> 16) & 0xFF] ^
+         shift_tables[3][crc >> 24];
+}
+
+__attribute__((target("sse4.2"))) auto ComputeWithSse42(const char *data, size_t size, uint32_t crc) -> uint32_t {
+  uint64_t crc64 = crc;
+  for (; size >= 3 * SSE42_BLOCK_SIZE; data += 3 * SSE42_BLOCK_SIZE, size -= 3 * SSE42_BLOCK_SIZE) {
+    uint64_t crc_b = 0;
+    uint64_t crc_c = 0;
+    for (size_t i = 0; i < SSE42_BLOCK_SIZE; i += sizeof(uint64_t)) {
+      uint64_t words[3];
+      memcpy(&words[0], data + i, sizeof(uint64_t));
+      memcpy(&words[1], data + SSE42_BLOCK_SIZE + i, sizeof(uint64_t));
+      memcpy(&words[2], data + 2 * SSE42_BLOCK_SIZE + i, sizeof(uint64_t));
+      crc64 = _mm_crc32_u64(crc64, words[0]);
+      crc_b = _mm_crc32_u64(crc_b, words[1]);
+      crc_c = _mm_crc32_u64(crc_c, words[2]);
+    }
+    // the checksum of a block started from zero is what the previous checksum adds to once shifted past it
+    crc = ShiftBlock(static_cast<uint32_t>(crc64)) ^ static_cast<uint32_t>(crc_b);
+    crc64 = ShiftBlock(crc) ^ static_cast<uint32_t>(crc_c);
+  }
+  for (; size >= sizeof(uint64_t); data += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; size > 0; data++, size--) {
+    crc = _mm_crc32_u8(crc, static_cast<uint8_t>(*data));
+  }
+  return crc;
+}
+#endif
+
+auto HasSse42() -> bool {
+#if defined(__x86_64__)
+  static const bool has_sse42 = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2") != 0;
+  }();
+  return has_sse42;
+#else
+  return false;
+#endif
+}
+}  // namespace
+
+auto Crc32c::Compute(const char *data, size_t size, uint32_t crc) -> uint32_t {
+#if defined(__x86_64__)
+  if (HasSse42()) {
+    return ~ComputeWithSse42(data, size, ~crc);
+  }
+#endif
+  return ComputeWithTable(data, size, crc);
+}
+
+auto Crc32c::ComputeWithTable(const char *data, size_t size, uint32_t crc) -> uint32_t {
+  const CrcTables &tables = GetTables();
+  crc = ~crc;
+  const auto *bytes = reinterpret_cast<const uint8_t *>(data);
+  for (; size >= 8; bytes += 8, size -= 8) {
+    uint32_t low = crc ^ (bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24);
+    crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^
+          tables[4][low >> 24] ^ tables[3][bytes[4]] ^ tables[2][bytes[5]] ^ tables[1][bytes[6]] ^
+          tables[0][bytes[7]];
+  }
+  for (; size > 0; bytes++, size--) {
+    crc = (crc >> 8) ^ tables[0][(crc ^ *bytes) & 0xFF];
+  }
+  return ~crc;
+}
+
+auto Crc32c::IsHardwareAccelerated() -> bool { return HasSse42(); }
+
+}  // namespace bustub
@@ -10,8 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -22,18 +25,49 @@
 
 namespace bustub {
 
+namespace {
+
+/** @return the bits of value in reverse order, so that sorting by it orders by the lowest bit first */
+auto ReverseBits(uint32_t value) -> uint32_t {
+  value = ((value >> 1) & 0x55555555) | ((value & 0x55555555) << 1);
+  value = ((value >> 2) & 0x33333333) | ((value & 0x33333333) << 2);
+  value = ((value >> 4) & 0x0F0F0F0F) | ((value & 0x0F0F0F0F) << 4);
+  value = ((value >> 8) & 0x00FF00FF) | ((value & 0x00FF00FF) << 8);
+  return (value >> 16) | (value << 16);
+}
+
+}  // namespace
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                     const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+                                     const KeyComparator &comparator, HashFunction<KeyType> hash_fn, bool swizzle)
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      hash_fn_(std::move(hash_fn)),
+      swizzle_(swizzle) {
+  auto root_page = reinterpret_cast<HashTableDirectoryRootPage *>(
+      buffer_pool_manager_->NewPage(&root_page_id_, nullptr)->GetData());
+  page_id_t segment_page_id;
+  auto segment_page = reinterpret_cast<HashTableDirectorySegmentPage *>(
+      buffer_pool_manager_->NewPageNear(root_page_id_, &segment_page_id)->GetData());
+  root_page->SetSegmentPageId(0, segment_page_id);
+  page_id_t directory_page_id;
   auto dir_page = reinterpret_cast<HashTableDirectoryPage *>(
-      buffer_pool_manager_->NewPage(&directory_page_id_, nullptr)->GetData());
+      buffer_pool_manager_->NewPageNear(segment_page_id, &directory_page_id)->GetData());
+  segment_page->SetDirectoryPageId(0, directory_page_id);
   page_id_t bucket_page_id;
-  buffer_pool_manager_->NewPage(&bucket_page_id, nullptr);
+  buffer_pool_manager_->NewPageNear(directory_page_id, &bucket_page_id);
   dir_page->SetBucketPageId(0, bucket_page_id);
 
   buffer_pool_manager_->UnpinPage(bucket_page_id, false, nullptr);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, true, nullptr);
+  buffer_pool_manager_->UnpinPages({root_page_id_, segment_page_id, directory_page_id}, true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_TYPE::~ExtendibleHashTable() {
+  if (swizzle_) {
+    buffer_pool_manager_->UnswizzleAll(this);
+  }
 }
 
 /*****************************************************************************
@@ -52,45 +86,322 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  uint32_t index = Hash(key) & dir_page->GetGlobalDepthMask();
+inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryRootPage *root_page) -> uint32_t {
+  uint32_t index = Hash(key) & root_page->GetGlobalDepthMask();
   return index;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  page_id_t page_id = dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
-  return page_id;
+auto HASH_TABLE_TYPE::LookupBucketPageId(const KeyType &key, uint32_t *bucket_idx) -> page_id_t {
+  uint32_t hash = Hash(key);
+  page_id_t segment_page_id = INVALID_PAGE_ID;
+  uint64_t version;
+  Page *page = buffer_pool_manager_->OptimisticFetchPage(root_page_id_, &version);
+  if (page != nullptr) {
+    auto root_page = reinterpret_cast<HashTableDirectoryRootPage *>(page->GetData());
+    // the read may be torn (or of another page altogether), so only trust the depth once it is known to be in range
+    uint32_t global_depth = root_page->GetGlobalDepth();
+    if (global_depth <= DIRECTORY_MAX_DEPTH) {
+      *bucket_idx = hash & ((1U << global_depth) - 1);
+      segment_page_id =
+          root_page->GetSegmentPageId(root_page->GetSegmentIndex(root_page->GetDirectoryIndex(*bucket_idx)));
+      if (!page->ValidateVersion(version)) {
+        segment_page_id = INVALID_PAGE_ID;
+      }
+    }
+  }
+  if (segment_page_id == INVALID_PAGE_ID) {
+    Page *raw_root_page;
+    auto root_page = FetchRootPage(&raw_root_page);
+    raw_root_page->RLatch();
+    *bucket_idx = hash & root_page->GetGlobalDepthMask();
+    segment_page_id =
+        root_page->GetSegmentPageId(root_page->GetSegmentIndex(root_page->GetDirectoryIndex(*bucket_idx)));
+    raw_root_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(root_page_id_, false, nullptr);
+  }
+
+  // segment and directory pages only go away under the table latch in write mode, so the page ids stay good
+  page_id_t directory_page_id = ReadSegmentSlot(segment_page_id, *bucket_idx / DIRECTORY_ARRAY_SIZE);
+  page = buffer_pool_manager_->OptimisticFetchPage(directory_page_id, &version);
+  if (page != nullptr) {
+    auto dir_page = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(*bucket_idx);
+    if (page->ValidateVersion(version)) {
+      return bucket_page_id;
+    }
+  }
+
+  Page *raw_dir_page;
+  auto dir_page = FetchDirectoryPage(directory_page_id, &raw_dir_page);
+  raw_dir_page->RLatch();
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(*bucket_idx);
+  raw_dir_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id, false, nullptr);
+  return bucket_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchRootPage(Page **page) -> HashTableDirectoryRootPage * {
+  Page *raw_page = buffer_pool_manager_->FetchPage(root_page_id_, nullptr);
+  if (page != nullptr) {
+    *page = raw_page;
+  }
+  auto root_page = reinterpret_cast<HashTableDirectoryRootPage *>(raw_page->GetData());
+  return root_page;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  auto directory_page = reinterpret_cast<HashTableDirectoryPage *>(
-      buffer_pool_manager_->FetchPage(directory_page_id_, nullptr)->GetData());
+auto HASH_TABLE_TYPE::FetchDirectoryPage(page_id_t directory_page_id, Page **page) -> HashTableDirectoryPage * {
+  Page *raw_page = buffer_pool_manager_->FetchPage(directory_page_id, nullptr);
+  if (page != nullptr) {
+    *page = raw_page;
+  }
+  auto directory_page = reinterpret_cast<HashTableDirectoryPage *>(raw_page->GetData());
   return directory_page;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  auto bucket_page =
-      reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(buffer_pool_manager_->FetchPage(bucket_page_id, nullptr)->GetData());
+auto HASH_TABLE_TYPE::ReadSegmentSlot(page_id_t segment_page_id, uint32_t directory_idx) -> page_id_t {
+  uint64_t version;
+  Page *page = buffer_pool_manager_->OptimisticFetchPage(segment_page_id, &version);
+  if (page != nullptr) {
+    auto segment_page = reinterpret_cast<HashTableDirectorySegmentPage *>(page->GetData());
+    page_id_t directory_page_id = segment_page->GetDirectoryPageId(directory_idx);
+    if (page->ValidateVersion(version)) {
+      return directory_page_id;
+    }
+  }
+
+  Page *raw_segment_page = buffer_pool_manager_->FetchPage(segment_page_id, nullptr);
+  auto segment_page = reinterpret_cast<HashTableDirectorySegmentPage *>(raw_segment_page->GetData());
+  raw_segment_page->RLatch();
+  page_id_t directory_page_id = segment_page->GetDirectoryPageId(directory_idx);
+  raw_segment_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(segment_page_id, false, nullptr);
+  return directory_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::GetDirectoryPageId(HashTableDirectoryRootPage *root_page, uint32_t directory_idx) -> page_id_t {
+  return ReadSegmentSlot(root_page->GetSegmentPageId(root_page->GetSegmentIndex(directory_idx)), directory_idx);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::AddDirectoryPage(HashTableDirectoryRootPage *root_page, uint32_t directory_idx,
+                                       page_id_t directory_page_id) {
+  uint32_t segment_idx = root_page->GetSegmentIndex(directory_idx);
+  page_id_t segment_page_id;
+  Page *raw_segment_page;
+  if (directory_idx % DIRECTORY_SEGMENT_ARRAY_SIZE == 0) {
+    raw_segment_page = buffer_pool_manager_->NewPageNear(directory_page_id, &segment_page_id);
+    assert(raw_segment_page != nullptr);
+    root_page->SetSegmentPageId(segment_idx, segment_page_id);
+  } else {
+    segment_page_id = root_page->GetSegmentPageId(segment_idx);
+    raw_segment_page = buffer_pool_manager_->FetchPage(segment_page_id, nullptr);
+  }
+  // the slot is past the end of the directory until the global depth grows, nobody reads it yet
+  reinterpret_cast<HashTableDirectorySegmentPage *>(raw_segment_page->GetData())
+      ->SetDirectoryPageId(directory_idx, directory_page_id);
+  buffer_pool_manager_->UnpinPage(segment_page_id, true, nullptr);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id, Page **page) -> HASH_TABLE_BUCKET_TYPE * {
+  Page *raw_page = buffer_pool_manager_->FetchPage(bucket_page_id, nullptr);
+  if (page != nullptr) {
+    *page = raw_page;
+  }
+  auto bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_page->GetData());
   return bucket_page;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchBucketPage(uint32_t bucket_idx, page_id_t bucket_page_id, Page **page)
+    -> HASH_TABLE_BUCKET_TYPE * {
+  Page *raw_page = nullptr;
+  auto &bucket_frame = bucket_frames_[bucket_idx % DIRECTORY_ARRAY_SIZE];
+  Page *frame = bucket_frame.load(std::memory_order_acquire);
+  if (frame != nullptr) {
+    raw_page = buffer_pool_manager_->FetchSwizzledPage(frame, bucket_page_id);
+  }
+  if (raw_page == nullptr) {
+    raw_page = buffer_pool_manager_->FetchPage(bucket_page_id, nullptr);
+    // stored while the page is pinned, so an eviction that would have to drop it cannot be under way
+    if (swizzle_ && buffer_pool_manager_->SwizzlePage(raw_page, this)) {
+      bucket_frame.store(raw_page, std::memory_order_release);
+    }
+  }
+  *page = raw_page;
+  return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_page->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::FetchLatchedBucket(const KeyType &key, bool exclusive, page_id_t *bucket_page_id, Page **page)
+    -> HASH_TABLE_BUCKET_TYPE * {
+  while (true) {
+    uint32_t bucket_idx;
+    *bucket_page_id = LookupBucketPageId(key, &bucket_idx);
+    auto *bucket_page = FetchBucketPage(bucket_idx, *bucket_page_id, page);
+    if (exclusive) {
+      (*page)->WLatch();
+    } else {
+      (*page)->RLatch();
+    }
+    // a split moving the key elsewhere updates the directory while holding this latch, so it is either over or not
+    // started yet
+    if (LookupBucketPageId(key, &bucket_idx) == *bucket_page_id) {
+      return bucket_page;
+    }
+    if (exclusive) {
+      (*page)->WUnlatch();
+    } else {
+      (*page)->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(*bucket_page_id, false, nullptr);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::Unswizzle(Page *page) {
+  for (auto &frame : bucket_frames_) {
+    Page *expected = page;
+    frame.compare_exchange_strong(expected, nullptr);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::ReadDirectorySlot(HashTableDirectoryRootPage *root_page, uint32_t bucket_idx,
+                                        page_id_t *bucket_page_id) -> uint32_t {
+  page_id_t directory_page_id = GetDirectoryPageId(root_page, root_page->GetDirectoryIndex(bucket_idx));
+  Page *raw_dir_page;
+  auto dir_page = FetchDirectoryPage(directory_page_id, &raw_dir_page);
+  raw_dir_page->RLatch();
+  *bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
+  uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx);
+  raw_dir_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(directory_page_id, false, nullptr);
+  return local_depth;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::SetBucketSlots(HashTableDirectoryRootPage *root_page, uint32_t bucket_idx, uint32_t local_depth,
+                                     page_id_t bucket_page_id) {
+  // the slots are visited in order, so each directory page is latched once
+  uint32_t step = 1U << local_depth;
+  page_id_t directory_page_id = INVALID_PAGE_ID;
+  Page *raw_dir_page = nullptr;
+  HashTableDirectoryPage *dir_page = nullptr;
+  uint32_t directory_idx = 0;
+  for (uint32_t i = bucket_idx & (step - 1); i < root_page->Size(); i += step) {
+    if (dir_page == nullptr || root_page->GetDirectoryIndex(i) != directory_idx) {
+      if (dir_page != nullptr) {
+        raw_dir_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(directory_page_id, true, nullptr);
+      }
+      directory_idx = root_page->GetDirectoryIndex(i);
+      directory_page_id = GetDirectoryPageId(root_page, directory_idx);
+      dir_page = FetchDirectoryPage(directory_page_id, &raw_dir_page);
+      // optimistic readers of the directory do not pin it; latching it bumps its version so they notice the change
+      raw_dir_page->WLatch();
+    }
+    dir_page->SetBucketPageId(i, bucket_page_id);
+    dir_page->SetLocalDepth(i, local_depth);
+  }
+  if (dir_page != nullptr) {
+    raw_dir_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(directory_page_id, true, nullptr);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::GrowDirectory(HashTableDirectoryRootPage *root_page, Page *raw_root_page) {
+  if (root_page->Size() < DIRECTORY_ARRAY_SIZE) {
+    page_id_t directory_page_id = GetDirectoryPageId(root_page, 0);
+    Page *raw_dir_page;
+    auto dir_page = FetchDirectoryPage(directory_page_id, &raw_dir_page);
+    raw_dir_page->WLatch();
+    dir_page->IncrGlobalDepth();
+    raw_dir_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(directory_page_id, true, nullptr);
+  } else {
+    // the upper half of the directory starts out as a copy of the lower half, one directory page at a time
+    uint32_t num_pages = root_page->NumDirectoryPages();
+    for (uint32_t i = 0; i < num_pages; i++) {
+      page_id_t directory_page_id = GetDirectoryPageId(root_page, i);
+      Page *raw_dir_page = buffer_pool_manager_->FetchPage(directory_page_id, nullptr);
+      page_id_t new_directory_page_id;
+      Page *new_page = buffer_pool_manager_->NewPageNear(directory_page_id, &new_directory_page_id);
+      assert(new_page != nullptr);
+      memcpy(new_page->GetData(), raw_dir_page->GetData(), PAGE_SIZE);
+      buffer_pool_manager_->UnpinPage(directory_page_id, false, nullptr);
+      buffer_pool_manager_->UnpinPage(new_directory_page_id, true, nullptr);
+      AddDirectoryPage(root_page, num_pages + i, new_directory_page_id);
+    }
+  }
+  raw_root_page->WLatch();
+  root_page->IncrGlobalDepth();
+  raw_root_page->WUnlatch();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::CanShrink(HashTableDirectoryRootPage *root_page) -> bool {
+  bool can_shrink = true;
+  for (uint32_t i = 0; i < root_page->NumDirectoryPages() && can_shrink; i++) {
+    page_id_t directory_page_id = GetDirectoryPageId(root_page, i);
+    Page *raw_dir_page;
+    auto dir_page = FetchDirectoryPage(directory_page_id, &raw_dir_page);
+    raw_dir_page->RLatch();
+    for (uint32_t j = 0; j < dir_page->Size() && can_shrink; j++) {
+      can_shrink = dir_page->GetLocalDepth(j) < root_page->GetGlobalDepth();
+    }
+    raw_dir_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(directory_page_id, false, nullptr);
+  }
+  return can_shrink;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ShrinkDirectory(HashTableDirectoryRootPage *root_page, Page *raw_root_page) {
+  while (root_page->GetGlobalDepth() > 0 && CanShrink(root_page)) {
+    uint32_t num_pages = root_page->NumDirectoryPages();
+    uint32_t num_segments = root_page->NumSegments();
+    raw_root_page->WLatch();
+    root_page->DecrGlobalDepth();
+    raw_root_page->WUnlatch();
+    if (num_pages > 1) {
+      // the upper half of the directory is a copy of the lower half
+      for (uint32_t i = num_pages / 2; i < num_pages; i++) {
+        DeleteOrRetirePage(GetDirectoryPageId(root_page, i));
+      }
+      for (uint32_t i = root_page->NumSegments(); i < num_segments; i++) {
+        DeleteOrRetirePage(root_page->GetSegmentPageId(i));
+      }
+    } else {
+      page_id_t directory_page_id = GetDirectoryPageId(root_page, 0);
+      Page *raw_dir_page;
+      auto dir_page = FetchDirectoryPage(directory_page_id, &raw_dir_page);
+      raw_dir_page->WLatch();
+      dir_page->DecrGlobalDepth();
+      raw_dir_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(directory_page_id, true, nullptr);
+    }
+  }
+}
+
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
   table_latch_.RLock();
-  auto dir_page = FetchDirectoryPage();
-  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
-  auto *bucket_page = FetchBucketPage(bucket_page_id);
-  reinterpret_cast<Page *>(bucket_page)->RLatch();
+  page_id_t bucket_page_id;
+  Page *raw_bucket_page;
+  auto *bucket_page = FetchLatchedBucket(key, false, &bucket_page_id, &raw_bucket_page);
   bool ret = bucket_page->GetValue(key, comparator_, result);
-  reinterpret_cast<Page *>(bucket_page)->RUnlatch();
+  raw_bucket_page->RUnlatch();
   buffer_pool_manager_->UnpinPage(bucket_page_id, false, nullptr);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
   table_latch_.RUnlock();
   return ret;
 }
@@ -101,19 +412,16 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
   table_latch_.RLock();
-  auto dir_page = FetchDirectoryPage();
-  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
-  HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
-
-  reinterpret_cast<Page *>(bucket_page)->WLatch();
+  page_id_t bucket_page_id;
+  Page *raw_bucket_page;
+  HASH_TABLE_BUCKET_TYPE *bucket_page = FetchLatchedBucket(key, true, &bucket_page_id, &raw_bucket_page);
   bool full = bucket_page->IsFull();
   bool done = false;
   if (!full) {
     done = bucket_page->Insert(key, value, comparator_);
   }
-  reinterpret_cast<Page *>(bucket_page)->WUnlatch();
+  raw_bucket_page->WUnlatch();
 
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
   buffer_pool_manager_->UnpinPage(bucket_page_id, true);
   table_latch_.RUnlock();
   // all latches unlocked before SplitInsert
@@ -125,46 +433,134 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  table_latch_.WLock();
-  auto dir_page = FetchDirectoryPage();
-  uint32_t bucket_idx = KeyToDirectoryIndex(key, dir_page);
-
-  page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
-  HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id);
-  // what if another thread changed full in Insert? check again :)
-  reinterpret_cast<Page *>(bucket_page)->WLatch();
-  if (!bucket_page->IsFull()) {
-    bool done = bucket_page->Insert(key, value, comparator_);
-    buffer_pool_manager_->UnpinPage(bucket_page_id, true, nullptr);
-    buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
-    reinterpret_cast<Page *>(bucket_page)->WUnlatch();
-    table_latch_.WUnlock();
-    return done;
-  }
-
-  if (dir_page->GetLocalDepth(bucket_idx) == dir_page->GetGlobalDepth()) {
-    dir_page->IncrGlobalDepth();
-  }
-
+  // create the split image up front, so that no latch is held while the buffer pool finds a frame for it
+  uint32_t bucket_idx;
+  table_latch_.RLock();
+  page_id_t near_page_id = LookupBucketPageId(key, &bucket_idx);
+  table_latch_.RUnlock();
   page_id_t new_bucket_page_id;
-  Page *new_page = buffer_pool_manager_->NewPage(&new_bucket_page_id);
+  Page *new_page = buffer_pool_manager_->NewPageNear(near_page_id, &new_bucket_page_id);
   assert(new_page != nullptr);
   new_page->WLatch();
   auto new_bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(new_page->GetData());
 
-  dir_page->IncrLocalDepth(bucket_idx);
-  auto new_bucket_idx = dir_page->GetSplitImageIndex(bucket_idx);
-  auto new_local_depth = dir_page->GetLocalDepth(bucket_idx);
-  auto new_local_mask = dir_page->GetLocalDepthMask(bucket_idx);
-  for (uint32_t i = 0; i < dir_page->Size(); i++) {
-    page_id_t page_id = dir_page->GetBucketPageId(i);
-    if (page_id == bucket_page_id) {
-      dir_page->SetLocalDepth(i, new_local_depth);
-      if ((i & new_local_mask) != (bucket_idx & new_local_mask)) {
-        dir_page->SetBucketPageId(i, new_bucket_page_id);
-      }
+  // Scenario: the directory has room for the split image, only the bucket and the directory pages need latching.
+  table_latch_.RLock();
+  page_id_t bucket_page_id;
+  Page *raw_bucket_page;
+  HASH_TABLE_BUCKET_TYPE *bucket_page = FetchLatchedBucket(key, true, &bucket_page_id, &raw_bucket_page);
+  bool done = false;
+  bool split = bucket_page->IsFull();
+  if (split) {
+    // the root page only changes under the table latch in write mode
+    auto root_page = FetchRootPage();
+    bucket_idx = KeyToDirectoryIndex(key, root_page);
+    page_id_t slot_page_id;
+    uint32_t local_depth = ReadDirectorySlot(root_page, bucket_idx, &slot_page_id);
+    assert(slot_page_id == bucket_page_id);
+    split = local_depth < root_page->GetGlobalDepth();
+    if (split) {
+      done = SplitBucket(root_page, bucket_idx, local_depth, bucket_page_id, bucket_page, new_bucket_page_id,
+                         new_bucket_page, key, value);
+    }
+    buffer_pool_manager_->UnpinPage(root_page_id_, false, nullptr);
+    if (!split) {
+      raw_bucket_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false, nullptr);
+      table_latch_.RUnlock();
+      return SplitInsertDoubling(transaction, key, value, new_page, new_bucket_page_id);
+    }
+  } else {
+    // another thread split the bucket in the meantime
+    done = bucket_page->Insert(key, value, comparator_);
+  }
+  // the split may have left every entry on one side, the key's bucket then has to split again
+  bool retry = split && !done && (bucket_page->IsFull() || new_bucket_page->IsFull());
+  raw_bucket_page->WUnlatch();
+  new_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true, nullptr);
+  buffer_pool_manager_->UnpinPage(new_bucket_page_id, split, nullptr);
+  if (!split) {
+    DeleteOrRetirePage(new_bucket_page_id);
+  }
+  table_latch_.RUnlock();
+  if (retry) {
+    return SplitInsert(transaction, key, value);
+  }
+  return done;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::SplitInsertDoubling(Transaction *transaction, const KeyType &key, const ValueType &value,
+                                          Page *new_page, page_id_t new_bucket_page_id) -> bool {
+  // Scenario: the directory doubles, which changes the directory index of every key: nobody else may be in the table.
+  table_latch_.WLock();
+  auto new_bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(new_page->GetData());
+  Page *raw_root_page;
+  auto root_page = FetchRootPage(&raw_root_page);
+  uint32_t bucket_idx = KeyToDirectoryIndex(key, root_page);
+  page_id_t bucket_page_id;
+  uint32_t local_depth = ReadDirectorySlot(root_page, bucket_idx, &bucket_page_id);
+  Page *raw_bucket_page;
+  HASH_TABLE_BUCKET_TYPE *bucket_page = FetchBucketPage(bucket_page_id, &raw_bucket_page);
+  raw_bucket_page->WLatch();
+  // what if another thread split the bucket while no latch was held? check again :)
+  bool full = bucket_page->IsFull();
+  bool grow = full && local_depth == root_page->GetGlobalDepth();
+  // a full bucket of a directory that is as large as it gets can't be split, the insert fails
+  bool split = full && (!grow || root_page->CanGrow());
+  if (split && grow) {
+    // neither can a bucket whose keys all share the hash bits of the new key, however large the directory gets
+    uint32_t max_depth_mask = (1U << DIRECTORY_MAX_DEPTH) - 1;
+    uint32_t hash = Hash(key) & max_depth_mask;
+    split = false;
+    for (size_t i = 0; i < BUCKET_ARRAY_SIZE && !split; i++) {
+      split = bucket_page->IsReadable(i) && (Hash(bucket_page->KeyAt(i)) & max_depth_mask) != hash;
     }
   }
+  bool done = false;
+  if (split) {
+    if (grow) {
+      GrowDirectory(root_page, raw_root_page);
+    }
+    done = SplitBucket(root_page, bucket_idx, local_depth, bucket_page_id, bucket_page, new_bucket_page_id,
+                       new_bucket_page, key, value);
+  } else if (!full) {
+    done = bucket_page->Insert(key, value, comparator_);
+  }
+  bool retry = split && !done && (bucket_page->IsFull() || new_bucket_page->IsFull());
+  raw_bucket_page->WUnlatch();
+  new_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(root_page_id_, grow && split, nullptr);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true, nullptr);
+  buffer_pool_manager_->UnpinPage(new_bucket_page_id, split, nullptr);
+  if (!split) {
+    DeleteOrRetirePage(new_bucket_page_id);
+  }
+  DeleteRetiredPages();
+  table_latch_.WUnlock();
+  if (retry) {
+    return SplitInsert(transaction, key, value);
+  }
+  return done;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::SplitBucket(HashTableDirectoryRootPage *root_page, uint32_t bucket_idx, uint32_t local_depth,
+                                  page_id_t bucket_page_id, HASH_TABLE_BUCKET_TYPE *bucket_page,
+                                  page_id_t new_bucket_page_id, HASH_TABLE_BUCKET_TYPE *new_bucket_page,
+                                  const KeyType &key, const ValueType &value) -> bool {
+  uint32_t new_local_depth = local_depth + 1;
+  uint32_t new_local_mask = (1U << new_local_depth) - 1;
+  uint32_t new_bucket_idx = bucket_idx ^ (1U << local_depth);
+  SetBucketSlots(root_page, bucket_idx, new_local_depth, bucket_page_id);
+  SetBucketSlots(root_page, new_bucket_idx, new_local_depth, new_bucket_page_id);
+  // threads looking for the split image now wait on its latch until it is filled
+
+  // the keys of the split image are those that agree with it in the low new_local_depth bits of their hash
+  auto in_split_image = [&](const KeyType &k) {
+    return (Hash(k) & new_local_mask) == (new_bucket_idx & new_local_mask);
+  };
   KeyType bucket_key;
   ValueType bucket_value;
   for (size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
@@ -173,27 +569,127 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
     }
     bucket_key = bucket_page->KeyAt(i);
     bucket_value = bucket_page->ValueAt(i);
-    auto new_idx = KeyToDirectoryIndex(bucket_key, dir_page);
-    if (new_idx == new_bucket_idx) {
+    if (in_split_image(bucket_key)) {
       bucket_page->RemoveAt(i);
       new_bucket_page->Insert(bucket_key, bucket_value, comparator_);
     }
   }
-  page_id_t new_idx = KeyToPageId(key, dir_page);
-  bool done;
-  if (new_idx == bucket_page_id) {
-    done = bucket_page->Insert(key, value, comparator_);
-  } else {
-    done = new_bucket_page->Insert(key, value, comparator_);
+  if (in_split_image(key)) {
+    return new_bucket_page->Insert(key, value, comparator_);
   }
+  return bucket_page->Insert(key, value, comparator_);
+}
 
-  reinterpret_cast<Page *>(bucket_page)->WUnlatch();
-  reinterpret_cast<Page *>(new_bucket_page)->WUnlatch();
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::BulkLoad(Transaction *transaction, const std::vector<std::pair<KeyType, ValueType>> &entries)
+    -> bool {
+  if (entries.empty()) {
+    return true;
+  }
+  table_latch_.WLock();
+  Page *raw_root_page;
+  auto root_page = FetchRootPage(&raw_root_page);
+  page_id_t old_bucket_page_id;
+  ReadDirectorySlot(root_page, 0, &old_bucket_page_id);
+  bool empty = root_page->GetGlobalDepth() == 0 && FetchBucketPage(old_bucket_page_id)->IsEmpty();
+  buffer_pool_manager_->UnpinPage(old_bucket_page_id, false);
+  if (!empty) {
+    buffer_pool_manager_->UnpinPage(root_page_id_, false);
+    table_latch_.WUnlock();
+    bool done = true;
+    for (const auto &[key, value] : entries) {
+      done = Insert(transaction, key, value) && done;
+    }
+    return done;
+  }
 
-  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
-  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
-  buffer_pool_manager_->UnpinPage(new_bucket_page_id, true);
+  // sorted by their hash read from the lowest bit up, the entries of a bucket are next to each other at any local depth
+  std::vector<std::pair<uint32_t, size_t>> order;
+  order.reserve(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    order.emplace_back(ReverseBits(Hash(entries[i].first)), i);
+  }
+  std::sort(order.begin(), order.end());
+
+  // cut the entries into buckets: a range of them is split on the next bit of the hash for as long as it doesn't fit
+  // into a bucket, just as a bucket splits when inserting one by one
+  struct BulkBucket {
+    size_t begin_;
+    size_t end_;
+    uint32_t bucket_idx_;
+    uint32_t local_depth_;
+  };
+  std::vector<BulkBucket> buckets;
+  std::vector<BulkBucket> ranges{{0, order.size(), 0, 0}};
+  uint32_t global_depth = 0;
+  while (!ranges.empty()) {
+    BulkBucket range = ranges.back();
+    ranges.pop_back();
+    // entries with the same hash can't be told apart by any bit, splitting them further only adds empty buckets
+    if (range.end_ - range.begin_ <= BUCKET_ARRAY_SIZE || range.local_depth_ == DIRECTORY_MAX_DEPTH ||
+        order[range.begin_].first == order[range.end_ - 1].first) {
+      buckets.push_back(range);
+      global_depth = std::max(global_depth, range.local_depth_);
+      continue;
+    }
+    uint32_t bit = 31 - range.local_depth_;
+    auto split = std::partition_point(order.begin() + range.begin_, order.begin() + range.end_,
+                                      [bit](const auto &entry) { return ((entry.first >> bit) & 1) == 0; });
+    auto middle = static_cast<size_t>(split - order.begin());
+    uint32_t local_depth = range.local_depth_ + 1;
+    ranges.push_back({middle, range.end_, range.bucket_idx_ | (1U << range.local_depth_), local_depth});
+    ranges.push_back({range.begin_, middle, range.bucket_idx_, local_depth});
+  }
+
+  // write the buckets next to each other, noting the directory slots of each
+  bool done = true;
+  std::vector<page_id_t> slot_page_ids(1U << global_depth);
+  std::vector<uint8_t> slot_local_depths(1U << global_depth);
+  page_id_t bucket_page_id = old_bucket_page_id;
+  for (const auto &bucket : buckets) {
+    Page *raw_bucket_page = buffer_pool_manager_->NewPageNear(bucket_page_id, &bucket_page_id);
+    assert(raw_bucket_page != nullptr);
+    auto bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_bucket_page->GetData());
+    for (size_t i = bucket.begin_; i < bucket.end_; i++) {
+      const auto &[key, value] = entries[order[i].second];
+      done = bucket_page->Insert(key, value, comparator_) && done;
+    }
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    for (uint32_t i = bucket.bucket_idx_; i < slot_page_ids.size(); i += 1U << bucket.local_depth_) {
+      slot_page_ids[i] = bucket_page_id;
+      slot_local_depths[i] = bucket.local_depth_;
+    }
+  }
 
+  // then the directory, one directory page at a time
+  uint32_t num_directory_pages = std::max<uint32_t>((1U << global_depth) / DIRECTORY_ARRAY_SIZE, 1);
+  page_id_t directory_page_id = GetDirectoryPageId(root_page, 0);
+  for (uint32_t i = 0; i < num_directory_pages; i++) {
+    Page *raw_dir_page = i == 0 ? buffer_pool_manager_->FetchPage(directory_page_id, nullptr)
+                                : buffer_pool_manager_->NewPageNear(directory_page_id, &directory_page_id);
+    assert(raw_dir_page != nullptr);
+    auto dir_page = reinterpret_cast<HashTableDirectoryPage *>(raw_dir_page->GetData());
+    while (dir_page->Size() < std::min<uint32_t>(1U << global_depth, DIRECTORY_ARRAY_SIZE)) {
+      dir_page->IncrGlobalDepth();
+    }
+    for (uint32_t j = 0; j < dir_page->Size(); j++) {
+      uint32_t bucket_idx = i * DIRECTORY_ARRAY_SIZE + j;
+      dir_page->SetBucketPageId(bucket_idx, slot_page_ids[bucket_idx]);
+      dir_page->SetLocalDepth(bucket_idx, slot_local_depths[bucket_idx]);
+    }
+    buffer_pool_manager_->UnpinPage(directory_page_id, true);
+    if (i > 0) {
+      AddDirectoryPage(root_page, i, directory_page_id);
+    }
+  }
+  while (root_page->GetGlobalDepth() < global_depth) {
+    root_page->IncrGlobalDepth();
+  }
+  buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  DeleteOrRetirePage(old_bucket_page_id);
   table_latch_.WUnlock();
   return done;
 }
@@ -204,20 +700,18 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
   table_latch_.RLock();
-  auto dir_page = FetchDirectoryPage();
-  auto bucket_idx = KeyToDirectoryIndex(key, dir_page);
-  auto bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
-  auto bucket_page = FetchBucketPage(bucket_page_id);
-
-  reinterpret_cast<Page *>(bucket_page)->WLatch();
+  page_id_t bucket_page_id;
+  Page *raw_bucket_page;
+  auto bucket_page = FetchLatchedBucket(key, true, &bucket_page_id, &raw_bucket_page);
   bool done = bucket_page->Remove(key, value, comparator_);
   uint32_t bucket_size = bucket_page->NumReadable();
-  reinterpret_cast<Page *>(bucket_page)->WUnlatch();
+  raw_bucket_page->WUnlatch();
 
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
   buffer_pool_manager_->UnpinPage(bucket_page_id, true);
   table_latch_.RUnlock();
-  if (bucket_size == 0) {
+  // all latches unlocked before Merge, which only runs when the bucket empties or drops to the merge threshold, not on
+  // every remove below it
+  if (done && (bucket_size == 0 || bucket_size == BUCKET_ARRAY_SIZE / 4)) {
     Merge(transaction, key, value);
   }
   return done;
@@ -228,50 +722,100 @@ auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  table_latch_.WLock();
-  auto dir_page = FetchDirectoryPage();
-  auto bucket_idx = KeyToDirectoryIndex(key, dir_page);
-  auto bucket_local_depth = dir_page->GetLocalDepth(bucket_idx);
-
-  // don't merge
-  if (bucket_local_depth == 0) {
-    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-    table_latch_.WUnlock();
-    return;
+  // merges hold two bucket latches, taking them one after the other: one merge at a time keeps them from deadlocking
+  std::unique_lock<std::mutex> merge_lock(merge_latch_);
+  table_latch_.RLock();
+  // the root page only changes under the table latch in write mode
+  auto root_page = FetchRootPage();
+  bool shrink = false;
+  while (MergeBucket(root_page, key, &shrink)) {
   }
-  auto split_idx = dir_page->GetSplitImageIndex(bucket_idx);
-  auto image_local_depth = dir_page->GetLocalDepth(split_idx);
-  if (image_local_depth != bucket_local_depth) {
-    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-    table_latch_.WUnlock();
+  buffer_pool_manager_->UnpinPage(root_page_id_, false);
+  shrink = shrink && CanShrink(root_page);
+  table_latch_.RUnlock();
+  merge_lock.unlock();
+
+  // Scenario: no bucket is as deep as the directory any more, halving it needs exclusive access.
+  if (shrink) {
+    table_latch_.WLock();
+    Page *raw_root_page;
+    root_page = FetchRootPage(&raw_root_page);
+    ShrinkDirectory(root_page, raw_root_page);
+    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+  } else if (!table_latch_.TryWLock()) {
+    // the merged buckets are deleted later, by whoever next holds the table latch in write mode
     return;
   }
-  page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx);
-  auto bucket_page = FetchBucketPage(bucket_page_id);
-  if (!bucket_page->IsEmpty()) {
-    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-    table_latch_.WUnlock();
-    return;
+  DeleteRetiredPages();
+  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::MergeBucket(HashTableDirectoryRootPage *root_page, const KeyType &key, bool *shrink) -> bool {
+  page_id_t bucket_page_id;
+  Page *raw_bucket_page;
+  HASH_TABLE_BUCKET_TYPE *bucket_page = FetchLatchedBucket(key, true, &bucket_page_id, &raw_bucket_page);
+  uint32_t bucket_idx = KeyToDirectoryIndex(key, root_page);
+  page_id_t slot_page_id;
+  uint32_t local_depth = ReadDirectorySlot(root_page, bucket_idx, &slot_page_id);
+  assert(slot_page_id == bucket_page_id);
+
+  // don't merge a bucket of local depth 0, or one whose split image was split further
+  uint32_t image_idx = local_depth > 0 ? bucket_idx ^ (1U << (local_depth - 1)) : bucket_idx;
+  page_id_t image_page_id = INVALID_PAGE_ID;
+  bool merge = local_depth > 0 && ReadDirectorySlot(root_page, image_idx, &image_page_id) == local_depth;
+  Page *raw_image_page = nullptr;
+  HASH_TABLE_BUCKET_TYPE *image_page = nullptr;
+  if (merge) {
+    image_page = FetchBucketPage(image_page_id, &raw_image_page);
+    raw_image_page->WLatch();
+    // the split image may have been split before its latch was taken, its slots can't change any more now
+    page_id_t image_slot_page_id;
+    merge = ReadDirectorySlot(root_page, image_idx, &image_slot_page_id) == local_depth &&
+            image_slot_page_id == image_page_id;
+    // two buckets that fit into half a bucket, so the merged bucket does not split again right away
+    merge = merge && bucket_page->NumReadable() + image_page->NumReadable() <= BUCKET_ARRAY_SIZE / 2;
   }
 
-  page_id_t image_page_id = dir_page->GetBucketPageId(split_idx);
-  for (uint32_t i = 0; i < dir_page->Size(); i++) {
-    page_id_t page_id = dir_page->GetBucketPageId(i);
-    if (page_id == bucket_page_id || page_id == image_page_id) {
-      dir_page->SetBucketPageId(i, image_page_id);
-      dir_page->DecrLocalDepth(i);
+  if (merge) {
+    for (size_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
+      if (bucket_page->IsReadable(i)) {
+        image_page->Insert(bucket_page->KeyAt(i), bucket_page->ValueAt(i), comparator_);
+        bucket_page->RemoveAt(i);
+      }
     }
+    SetBucketSlots(root_page, bucket_idx, local_depth - 1, image_page_id);
+    *shrink = *shrink || local_depth == root_page->GetGlobalDepth();
   }
+  if (raw_image_page != nullptr) {
+    raw_image_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(image_page_id, merge);
+  }
+  raw_bucket_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, merge);
+  if (merge) {
+    // threads that looked the bucket up before the merge may still fetch it, it must stay allocated until they are gone
+    std::lock_guard<std::mutex> lg(retired_latch_);
+    retired_page_ids_.push_back(bucket_page_id);
+  }
+  return merge;
+}
 
-  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-  buffer_pool_manager_->DeletePage(bucket_page_id);
-
-  while (dir_page->CanShrink()) {
-    dir_page->DecrGlobalDepth();
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteOrRetirePage(page_id_t page_id) {
+  if (!buffer_pool_manager_->DeletePage(page_id)) {
+    std::lock_guard<std::mutex> lg(retired_latch_);
+    retired_page_ids_.push_back(page_id);
   }
-  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
-  table_latch_.WUnlock();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteRetiredPages() {
+  std::lock_guard<std::mutex> lg(retired_latch_);
+  // a page the buffer pool itself still has pinned, e.g. to write it back, is tried again next time
+  auto deleted = std::remove_if(retired_page_ids_.begin(), retired_page_ids_.end(),
+                                [this](page_id_t page_id) { return buffer_pool_manager_->DeletePage(page_id); });
+  retired_page_ids_.erase(deleted, retired_page_ids_.end());
 }
 
 /*****************************************************************************
@@ -280,9 +824,12 @@ void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
   table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  uint32_t global_depth = dir_page->GetGlobalDepth();
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
+  Page *raw_root_page;
+  HashTableDirectoryRootPage *root_page = FetchRootPage(&raw_root_page);
+  raw_root_page->RLatch();
+  uint32_t global_depth = root_page->GetGlobalDepth();
+  raw_root_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(root_page_id_, false, nullptr);
   table_latch_.RUnlock();
   return global_depth;
 }
@@ -293,9 +840,47 @@ uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
   table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr);
+  Page *raw_root_page;
+  HashTableDirectoryRootPage *root_page = FetchRootPage(&raw_root_page);
+  raw_root_page->RLatch();
+  uint32_t global_depth = root_page->GetGlobalDepth();
+  // the invariants of HashTableDirectoryPage::VerifyIntegrity, checked across all directory pages
+  std::unordered_map<page_id_t, uint32_t> page_id_to_count;
+  std::unordered_map<page_id_t, uint32_t> page_id_to_ld;
+  for (uint32_t i = 0; i < root_page->NumDirectoryPages(); i++) {
+    page_id_t directory_page_id = GetDirectoryPageId(root_page, i);
+    Page *raw_dir_page;
+    HashTableDirectoryPage *dir_page = FetchDirectoryPage(directory_page_id, &raw_dir_page);
+    raw_dir_page->RLatch();
+    if (root_page->NumDirectoryPages() == 1) {
+      assert(dir_page->GetGlobalDepth() == global_depth);
+      dir_page->VerifyIntegrity();
+    }
+    for (uint32_t j = 0; j < dir_page->Size(); j++) {
+      page_id_t curr_page_id = dir_page->GetBucketPageId(j);
+      uint32_t curr_ld = dir_page->GetLocalDepth(j);
+      assert(curr_ld <= global_depth);
+      ++page_id_to_count[curr_page_id];
+      auto it = page_id_to_ld.emplace(curr_page_id, curr_ld).first;
+      if (it->second != curr_ld) {
+        LOG_WARN("Verify Integrity: curr_local_depth: %u, old_local_depth %u, for page_id: %u", curr_ld, it->second,
+                 curr_page_id);
+        assert(it->second == curr_ld);
+      }
+    }
+    raw_dir_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(directory_page_id, false, nullptr);
+  }
+  for (const auto &[curr_page_id, curr_count] : page_id_to_count) {
+    uint32_t required_count = 0x1 << (global_depth - page_id_to_ld[curr_page_id]);
+    if (curr_count != required_count) {
+      LOG_WARN("Verify Integrity: curr_count: %u, required_count %u, for page_id: %u", curr_count, required_count,
+               curr_page_id);
+      assert(curr_count == required_count);
+    }
+  }
+  raw_root_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(root_page_id_, false, nullptr);
   table_latch_.RUnlock();
 }
 
@@ -15,14 +15,36 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "buffer/buffer_pool_stats.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/scan_handle.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/**
+ * How a caller is going to use the pages it fetches. Strategies other than NORMAL keep a bulk access from flushing
+ * the rest of the pool: its misses cycle through a small ring of frames instead of taking new victims.
+ *
+ * There is one ring per strategy and buffer pool instance, not one per scan: concurrent scans of an instance, and the
+ * instance's read-ahead, share its SEQUENTIAL ring. Together they take no more frames than one scan would, at the
+ * cost of recycling each other's pages sooner. A ring frame is only recycled once it is unpinned, so the page a scan
+ * is on is never taken away from it; when every frame of the ring is pinned, a miss takes an ordinary victim.
+ */
+enum class AccessStrategy {
+  /** Point accesses; pages compete for frames through the replacer. */
+  NORMAL,
+  /** Read-mostly walk over many pages, e.g. a full table scan (ring of SEQUENTIAL_RING_SIZE frames). */
+  SEQUENTIAL,
+  /** Walk that dirties many pages, e.g. loading a table (ring of BULK_WRITE_RING_SIZE frames). */
+  BULK_WRITE,
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -45,6 +67,92 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetch a page on behalf of an access with the given strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy how the caller is going to access this and the following pages
+   * @param callback grading callback
+   * @return the requested page
+   */
+  auto FetchPage(page_id_t page_id, AccessStrategy strategy, bufferpool_callback_fn callback = nullptr) -> Page * {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto *result = FetchPgImp(page_id, strategy);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
+  /**
+   * Fetch a page for a sequential scan, like FetchPage(page_id, AccessStrategy::SEQUENTIAL). The fetch also feeds the
+   * scan's read-ahead detector, which reads the pages after it in the background once the scan is seen fetching them
+   * in order.
+   * @param page_id id of page to be fetched
+   * @param scan the read-ahead state of the scan
+   * @param callback grading callback
+   * @return the requested page
+   */
+  auto FetchScanPage(page_id_t page_id, ScanHandle *scan, bufferpool_callback_fn callback = nullptr) -> Page * {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto *result = FetchScanPgImp(page_id, scan);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
+  /**
+   * Look up a resident page for an optimistic read, without pinning it. The caller must call
+   * Page::ValidateVersion(*version) after reading and discard what it read if that fails.
+   * @param page_id id of page to be read
+   * @param[out] version the page's version when the read started
+   * @return the page, or nullptr if it is not resident, is being written, or the buffer pool cannot tell
+   */
+  auto OptimisticFetchPage(page_id_t page_id, uint64_t *version) -> Page * {
+    return OptimisticFetchPgImp(page_id, version);
+  }
+
+  /**
+   * Pin a page through a swizzled reference, without looking it up in the page table.
+   * @param page the frame the reference points to
+   * @param page_id the page the reference stands for
+   * @return the page, or nullptr if the frame no longer holds it; the caller then fetches it by id
+   */
+  auto FetchSwizzledPage(Page *page, page_id_t page_id) -> Page * { return FetchSwizzledPgImp(page, page_id); }
+
+  /**
+   * Allow an owner to keep direct pointers to the frame of a page until the page leaves it. The owner's Unswizzle is
+   * called before that happens. A frame has at most one owner.
+   * @param page a page the caller has pinned
+   * @param owner the owner of the references
+   * @return false if the page may not be swizzled, because the buffer pool does not support it or another owner has
+   */
+  auto SwizzlePage(Page *page, SwizzleOwner *owner) -> bool { return SwizzlePgImp(page, owner); }
+
+  /**
+   * Drop an owner from all the frames it swizzled, e.g. before it is destroyed. Unswizzle is not called.
+   * @param owner the owner of the references
+   */
+  void UnswizzleAll(SwizzleOwner *owner) { UnswizzleAllImp(owner); }
+
+  /**
+   * Fetch several pages at once. Pages of one buffer pool instance are fetched under a single acquisition of its latch
+   * and their misses are read from disk together.
+   * @param page_ids ids of the pages to fetch, duplicates allowed (each occurrence is one pin)
+   * @param[out] pages the fetched pages, one per page id and nullptr where a page could not be fetched
+   * @param strategy how the caller is going to access the pages
+   */
+  void FetchPages(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages,
+                  AccessStrategy strategy = AccessStrategy::NORMAL) {
+    FetchPgsImp(page_ids, pages, strategy);
+  }
+
+  /**
+   * Unpin several pages at once.
+   * @param page_ids ids of the pages to unpin, one occurrence per pin to drop
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if any of the pages was not resident or not pinned
+   */
+  auto UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) -> bool {
+    return UnpinPgsImp(page_ids, is_dirty);
+  }
+
   /** Grading function. Do not modify! */
   auto UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) -> bool {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -84,6 +192,54 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Grow or shrink the buffer pool while it is in use.
+   * @param pool_size the number of frames the pool should have
+   * @return the number of frames the pool has afterwards, which may differ if pinned pages kept it from shrinking
+   */
+  auto ResizePool(size_t pool_size) -> size_t { return ResizePoolImp(pool_size); }
+
+  /**
+   * Create a new page close to another page of the same table or index, so that the pages of one object end up in
+   * extents of their own and are read back sequentially.
+   * @param near_page_id a page of the same object, INVALID_PAGE_ID for none
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPageNear(page_id_t near_page_id, page_id_t *page_id) -> Page * { return NewPgNearImp(near_page_id, page_id); }
+
+  /**
+   * List the pages in the buffer pool, hottest first: pinned pages, then the others from most to least recently used
+   * as far as the replacement policy can tell. Pages that only a scan brought in are left out.
+   * @param[out] page_ids the page ids
+   */
+  void GetResidentPages(std::vector<page_id_t> *page_ids) { GetResidentPgsImp(page_ids); }
+
+  /**
+   * Read pages into free frames in page id order, without evicting anything. The pages are left unpinned.
+   * @param page_ids the pages to read
+   * @return the number of pages that were read in
+   */
+  auto PrefetchPages(const std::vector<page_id_t> &page_ids) -> size_t { return PrefetchPgsImp(page_ids); }
+
+  /**
+   * Take a snapshot of the buffer pool's counters.
+   * @param[out] instance_stats if not nullptr, the counters of each buffer pool instance
+   * @return the counters summed over all instances
+   */
+  auto GetStats(std::vector<BufferPoolStats> *instance_stats = nullptr) -> BufferPoolStats {
+    std::vector<BufferPoolStats> stats;
+    GetStatsImp(&stats);
+    BufferPoolStats total;
+    for (const auto &instance : stats) {
+      total += instance;
+    }
+    if (instance_stats != nullptr) {
+      *instance_stats = std::move(stats);
+    }
+    return total;
+  }
+
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
@@ -108,6 +264,82 @@ class BufferPoolManager {
    */
   virtual auto FetchPgImp(page_id_t page_id) -> Page * = 0;
 
+  /**
+   * Fetch the requested page from the buffer pool on behalf of an access with the given strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy how the caller is going to access this and the following pages
+   * @return the requested page
+   */
+  virtual auto FetchPgImp(page_id_t page_id, AccessStrategy strategy) -> Page * { return FetchPgImp(page_id); }
+
+  /**
+   * Fetch the requested page for a sequential scan. The default does not read ahead.
+   * @param page_id id of page to be fetched
+   * @param scan the read-ahead state of the scan
+   * @return the requested page
+   */
+  virtual auto FetchScanPgImp(page_id_t page_id, ScanHandle *scan) -> Page * {
+    return FetchPgImp(page_id, AccessStrategy::SEQUENTIAL);
+  }
+
+  /**
+   * Look up a resident page for an optimistic read, without pinning it.
+   * @param page_id id of page to be read
+   * @param[out] version the page's version when the read started
+   * @return the page, or nullptr if an optimistic read is not possible right now
+   */
+  virtual auto OptimisticFetchPgImp(page_id_t page_id, uint64_t *version) -> Page * { return nullptr; }
+
+  /**
+   * Pin a page through a swizzled reference. The default never can.
+   * @param page the frame the reference points to
+   * @param page_id the page the reference stands for
+   * @return the page, or nullptr if the frame no longer holds it
+   */
+  virtual auto FetchSwizzledPgImp(Page *page, page_id_t page_id) -> Page * { return nullptr; }
+
+  /**
+   * Allow an owner to keep direct pointers to the frame of a pinned page. The default does not allow it.
+   * @param page a pinned page
+   * @param owner the owner of the references
+   * @return false if the page may not be swizzled
+   */
+  virtual auto SwizzlePgImp(Page *page, SwizzleOwner *owner) -> bool { return false; }
+
+  /**
+   * Drop an owner from all the frames it swizzled.
+   * @param owner the owner of the references
+   */
+  virtual void UnswizzleAllImp(SwizzleOwner *owner) {}
+
+  /**
+   * Fetch several pages at once. The default fetches them one by one.
+   * @param page_ids ids of the pages to fetch
+   * @param[out] pages the fetched pages, nullptr where a page could not be fetched
+   * @param strategy how the caller is going to access the pages
+   */
+  virtual void FetchPgsImp(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages,
+                           AccessStrategy strategy) {
+    pages->clear();
+    for (auto page_id : page_ids) {
+      pages->push_back(FetchPgImp(page_id, strategy));
+    }
+  }
+
+  /**
+   * Unpin several pages at once. The default unpins them one by one.
+   * @param page_ids ids of the pages to unpin
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if any of the pages was not resident or not pinned
+   */
+  virtual auto UnpinPgsImp(const std::vector<page_id_t> &page_ids, bool is_dirty) -> bool {
+    bool unpinned = true;
+    for (auto page_id : page_ids) {
+      unpinned = UnpinPgImp(page_id, is_dirty) && unpinned;
+    }
+    return unpinned;
+  }
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -130,6 +362,14 @@ class BufferPoolManager {
    */
   virtual auto NewPgImp(page_id_t *page_id) -> Page * = 0;
 
+  /**
+   * Creates a new page in the buffer pool, close to another page. The default ignores the hint.
+   * @param near_page_id a page of the same object, INVALID_PAGE_ID for none
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual auto NewPgNearImp(page_id_t near_page_id, page_id_t *page_id) -> Page * { return NewPgImp(page_id); }
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -141,5 +381,31 @@ class BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   virtual void FlushAllPgsImp() = 0;
+
+  /**
+   * Grow or shrink the buffer pool. The default cannot resize.
+   * @param pool_size the number of frames the pool should have
+   * @return the number of frames the pool has afterwards
+   */
+  virtual auto ResizePoolImp(size_t pool_size) -> size_t { return GetPoolSize(); }
+
+  /**
+   * List the pages in the buffer pool, hottest first. The default lists nothing.
+   * @param[out] page_ids the page ids
+   */
+  virtual void GetResidentPgsImp(std::vector<page_id_t> *page_ids) { page_ids->clear(); }
+
+  /**
+   * Read pages into free frames without evicting anything. The default reads nothing.
+   * @param page_ids the pages to read
+   * @return the number of pages that were read in
+   */
+  virtual auto PrefetchPgsImp(const std::vector<page_id_t> &page_ids) -> size_t { return 0; }
+
+  /**
+   * Take a snapshot of the counters of each instance. The default has no counters.
+   * @param[out] stats the counters, one entry per instance
+   */
+  virtual void GetStatsImp(std::vector<BufferPoolStats> *stats) { stats->clear(); }
 };
 }  // namespace bustub
@@ -12,12 +12,24 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/extent_allocator.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_router.h"
+#include "buffer/page_table.h"
+#include "common/timed_mutex.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -26,6 +38,18 @@ namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * Dirty pages are not written when they are unpinned. A background writer thread per instance wakes up every
+ * background_writer_interval and, once more than background_writer_dirty_ratio of the frames are dirty, writes
+ * unpinned dirty frames back in page id order so that misses can usually evict a clean frame.
+ *
+ * Fetching a resident page and unpinning a page do not take latch_: they look the page up in the lock-free page_table_
+ * and adjust the frame's atomic pin count. latch_ is only taken for misses, evictions and other changes to the mapping.
+ * The replacer is only told about a frame when its pin count goes from 0 to 1 or back.
+ *
+ * The pool can be resized online between 1 and max_pool_size frames. Address space for max_pool_size frames is reserved
+ * up front in a FrameArena and frames only take memory once they are added; retired frames give their data back to
+ * the OS.
  */
 class BufferPoolManagerInstance : public BufferPoolManager {
  public:
@@ -34,8 +58,11 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param max_pool_size the size ResizePool can grow the buffer pool to, 0 for pool_size
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, size_t max_pool_size = 0);
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,12 +70,19 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param max_pool_size the size ResizePool can grow the buffer pool to, 0 for pool_size
+   * @param router the routing of page ids to the BPIs of the parallel BPM, nullptr for page_id % num_instances
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, size_t max_pool_size = 0,
+                            const PageRouter *router = nullptr);
 
   /**
-   * Destroys an existing BufferPoolManagerInstance.
+   * Destroys an existing BufferPoolManagerInstance. The dirty pages are written back first, then the background writer
+   * and the read-ahead thread are stopped. The instance must be destroyed before its disk manager is shut down:
+   * DiskManager::WritePage drops writes after DiskManager::ShutDown, and the pages still dirty would be lost.
    */
   ~BufferPoolManagerInstance() override;
 
@@ -58,14 +92,78 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return pointer to all the pages in the buffer pool */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @return true if a new page would not have to evict one; only a hint, the answer can change right away */
+  auto HasFreeFrame() -> bool;
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
-   * @return the requested page
+   * @return the requested page, or nullptr if every frame is pinned, the page is not allocated, or it could not be
+   * read or does not match its checksum
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * Fetch the requested page from the buffer pool on behalf of an access with the given strategy. A SEQUENTIAL or
+   * BULK_WRITE miss reuses the oldest frame of that strategy's ring once the ring is full, so the access never takes
+   * more than the ring's frames away from other pages.
+   * @param page_id id of page to be fetched
+   * @param strategy how the caller is going to access this and the following pages
+   * @return the requested page, or nullptr as for FetchPgImp(page_id_t)
+   */
+  auto FetchPgImp(page_id_t page_id, AccessStrategy strategy) -> Page * override;
+
+  /**
+   * Fetch the requested page for a sequential scan, feeding the scan's window of this instance to the read-ahead
+   * detector (see ReadAhead) first.
+   * @param page_id id of page to be fetched
+   * @param scan the read-ahead state of the scan
+   * @return the requested page, or nullptr as for FetchPgImp(page_id_t)
+   */
+  auto FetchScanPgImp(page_id_t page_id, ScanHandle *scan) -> Page * override;
+
+  /**
+   * Look up a resident page for an optimistic read, without pinning it or taking any latch.
+   * @param page_id id of page to be read
+   * @param[out] version the page's version when the read started
+   * @return the page, or nullptr if it is not resident or is being written
+   */
+  auto OptimisticFetchPgImp(page_id_t page_id, uint64_t *version) -> Page * override;
+
+  /**
+   * Pin a page through a swizzled reference with a lock-free pin that is validated against the page id.
+   * @param page the frame the reference points to, possibly of another instance
+   * @param page_id the page the reference stands for
+   * @return the page, or nullptr if the frame no longer holds it
+   */
+  auto FetchSwizzledPgImp(Page *page, page_id_t page_id) -> Page * override;
+
+  /**
+   * Record the owner of the swizzled references to a pinned page of this instance.
+   * @param page a pinned page
+   * @param owner the owner of the references
+   * @return false if the page is not one of this instance's or another owner has swizzled it
+   */
+  auto SwizzlePgImp(Page *page, SwizzleOwner *owner) -> bool override;
+
+  /**
+   * Drop an owner from all the frames of this instance.
+   * @param owner the owner of the references
+   */
+  void UnswizzleAllImp(SwizzleOwner *owner) override;
+
+  /**
+   * Fetch several pages of this instance at once. Hits are pinned without latch_; the misses are reserved under one
+   * acquisition of latch_ and read with a single DiskManager::ReadPages call in page id order. Pages another thread is
+   * reading in are fetched one by one afterwards, so two batches can never wait on each other.
+   * @param page_ids ids of the pages to fetch
+   * @param[out] pages the fetched pages, nullptr where a page could not be fetched
+   * @param strategy how the caller is going to access the pages
+   */
+  void FetchPgsImp(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages,
+                   AccessStrategy strategy) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -75,7 +173,8 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
 
   /**
-   * Flushes the target page to disk.
+   * Flushes the target page to disk. The write happens without latch_, with the page pinned and read-latched, so the
+   * caller must not hold the page's write latch.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
@@ -88,6 +187,15 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   auto NewPgImp(page_id_t *page_id) -> Page * override;
 
+  /**
+   * Creates a new page in the buffer pool, in the extent of near_page_id if it has room (see ExtentAllocator). The
+   * disk space of an extent is preallocated when its first page is created.
+   * @param near_page_id a page of the same object, INVALID_PAGE_ID for none
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgNearImp(page_id_t near_page_id, page_id_t *page_id) -> Page * override;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -96,23 +204,60 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the pages in the buffer pool to disk: the dirty pages are written back in page id order, in batches of
+   * FLUSH_BATCH_SIZE that each take one DiskManager::WritePages call, see FlushBatch.
    */
   void FlushAllPgsImp() override;
 
   /**
-   * Allocate a page on disk.∂
+   * Grows or shrinks the buffer pool. Added frames go to the free list. Frames are retired from the end of the pool:
+   * their dirty pages are written back first and clean pages are moved to free frames that stay, if there are any,
+   * or else evicted. A pinned page cannot be moved, so it stops the pool from shrinking any further.
+   * @param pool_size the number of frames the pool should have, clamped to [1, max_pool_size]
+   * @return the number of frames the pool has afterwards
+   */
+  auto ResizePoolImp(size_t pool_size) -> size_t override;
+
+  /**
+   * Lists pinned pages first, then the other pages in the reverse of the replacer's eviction order. Pages in a
+   * SEQUENTIAL or BULK_WRITE ring are left out.
+   * @param[out] page_ids the page ids
+   */
+  void GetResidentPgsImp(std::vector<page_id_t> *page_ids) override;
+
+  /**
+   * Reads the pages that are not resident in batches, in page id order, until the free list runs out.
+   * @param page_ids the pages to read
+   * @return the number of pages that were read in
+   */
+  auto PrefetchPgsImp(const std::vector<page_id_t> &page_ids) -> size_t override;
+
+  /**
+   * Takes a snapshot of this instance's counters.
+   * @param[out] stats one entry, for this instance
+   */
+  void GetStatsImp(std::vector<BufferPoolStats> *stats) override;
+
+  /**
+   * Allocate a page on disk.
+   * @param near_page_id a page of the same object, INVALID_PAGE_ID for none
+   * @param[out] new_extent set to true if the page is the first of an empty extent
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(page_id_t near_page_id, bool *new_extent) -> page_id_t;
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, so that its id can be handed out again.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id) { allocator_.Free(page_id); }
+
+  /**
+   * A page that is not allocated has no contents to read; loading it anyway would map its id to a frame that a later
+   * NewPgImp handing the id out again knows nothing about. Requires latch_.
+   * @return true if the page is allocated
+   */
+  auto IsAllocated(page_id_t page_id) const -> bool;
 
   /**
    * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
@@ -121,29 +266,77 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
+  /** Number of pages in the buffer pool. Changed under latch_, read by lock-free hits. */
+  std::atomic<size_t> pool_size_{0};
+  /** Number of pages the buffer pool can grow to. */
+  const size_t max_pool_size_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
   const uint32_t num_instances_ = 1;
   /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
   const uint32_t instance_index_ = 0;
-  /** Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_ */
-  std::atomic<page_id_t> next_page_id_ = instance_index_;
+  /** The router of the parallel BPM, or owned_router_. Page ids handed out must route back to instance_index_. */
+  std::unique_ptr<PageRouter> owned_router_;
+  const PageRouter *router_;
+  /** Hands out the page ids of this BPI and takes deleted ones back. Protected by latch_. */
+  ExtentAllocator allocator_;
 
+  /** The memory of the buffer pool: the page data of the frames and the descriptor array pages_. */
+  FrameArena arena_;
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** Number of descriptors in pages_ that were constructed. Retired frames keep theirs until the pool is destroyed. */
+  size_t num_constructed_frames_{0};
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /** Page table for keeping track of buffer pool pages. Modified under latch_, read without it. */
+  PageTable page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  /**
+   * Serializes changes to page_table_, free_list_, pages_in_writeback_ and the page a frame holds. Disk I/O is never
+   * performed while holding it: a frame that is being filled is marked io_in_progress_ and waited on through io_cv_.
+   * A frame is only reassigned after its pin count was swapped from 0 to -1, which lock-free pins cannot get past.
+   * It keeps count of how long threads wait for it, for GetStats.
+   */
+  TimedMutex latch_;
+  /** Serializes ResizePoolImp calls, which release latch_ while writing back the pages of the frames they retire. */
+  std::mutex resize_latch_;
+  /** Signalled (under latch_) whenever a frame finishes its I/O or a victim or cleaned page is written back. */
+  std::condition_variable_any io_cv_;
+  /** The frames owned by the SEQUENTIAL and BULK_WRITE rings, oldest first, shared by all the scans of the instance. */
+  std::deque<frame_id_t> sequential_ring_;
+  std::deque<frame_id_t> bulk_write_ring_;
+  /** The ring each frame belongs to, NORMAL if none. Written under latch_, read by lock-free hits. */
+  std::vector<std::atomic<AccessStrategy>> frame_strategies_;
+  /** Evicted dirty pages whose write-back has not reached disk yet; they must not be read in again until it has. */
+  std::unordered_set<page_id_t> pages_in_writeback_;
+  /** Wakes the background writer early (when a miss had to evict a dirty frame) or tells it to stop. */
+  std::condition_variable_any background_writer_cv_;
+  /** Set under latch_ by the destructor to stop the background writer and the read-ahead thread. */
+  bool stop_threads_{false};
+  /** The number of frames the background writer, FlushPgImp or FlushAllPgsImp is writing back and holds a pin on. */
+  size_t num_cleaning_frames_{0};
+  /** Trickles dirty unpinned frames to disk, see RunBackgroundWriter. */
+  std::thread background_writer_;
+  /** Pages queued for read-ahead by all the scans of the instance, in the order they were queued. */
+  std::deque<page_id_t> read_ahead_queue_;
+  /** Wakes the read-ahead thread when pages are queued or tells it to stop. */
+  std::condition_variable_any read_ahead_cv_;
+  /** Reads queued pages into SEQUENTIAL ring frames ahead of the scan, see RunReadAhead. */
+  std::thread read_ahead_thread_;
+
+  /** Counters behind GetStats, see BufferPoolStats. Hits are counted on the lock-free path, so they are striped. */
+  StripedCounter hits_;
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> prefetches_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> eviction_writes_{0};
+  std::atomic<uint64_t> background_writes_{0};
+  std::atomic<uint64_t> victim_searches_{0};
 
  private:
   /**
@@ -154,15 +347,195 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   auto FindPg(page_id_t page_id) -> frame_id_t;
 
   /**
-   * get free frame from free_list_ or replacer_
-   * @return frame_id_t of the free frame in the buffer
+   * Pin a resident page without taking latch_. Fails whenever the outcome is not clear-cut (the page is not found, is
+   * still being read in, or its frame is being reassigned); the caller then retries under latch_.
+   * @param page_id id of page to pin
+   * @return the pinned frame, or -1
+   */
+  auto TryPinPg(page_id_t page_id) -> frame_id_t;
+
+  /**
+   * Pin a frame without taking latch_ if it holds a page that is done being read in.
+   * @param frame_id the frame to pin
+   * @param page_id the page the frame should hold
+   * @return false if the frame is being reassigned or holds another page
+   */
+  auto TryPinFrame(frame_id_t frame_id, page_id_t page_id) -> bool;
+
+  /** Add a pin to a frame that is known to hold a valid page, telling the replacer if it was unpinned. */
+  void PinFrame(frame_id_t frame_id);
+
+  /** Drop a pin from a frame, handing the frame to the replacer if it was the last one. */
+  void UnpinFrame(frame_id_t frame_id);
+
+  /** Take a frame that a point access pinned out of the scan ring it is in, if any. */
+  void LeaveRing(frame_id_t frame_id);
+
+  /** Have the owner of the swizzled references to a frame drop them, before the frame gets another page. */
+  void UnswizzleFrame(frame_id_t frame_id);
+
+  /** Drop the page of a claimed frame without writing it back and put the frame on the free list. */
+  void RemoveFrame(frame_id_t frame_id);
+
+  /**
+   * Take an unpinned frame away from pinners (pin count 0 -> -1) so it can be reassigned. Requires latch_.
+   * @return false if the frame is pinned
+   */
+  auto ClaimFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * find if a page exists in page_table_, waiting out any I/O that is still in flight for it.
+   * The caller must hold latch_ through lock; it is released while waiting.
+   * @param page_id id of page to find
+   * @param lock the caller's lock on latch_
+   * @return the frame id of the page, or -1 if it is not resident and not being written back.
+   */
+  auto FindPgOrWait(page_id_t page_id, std::unique_lock<TimedMutex> *lock) -> frame_id_t;
+
+  /**
+   * Wait for the background writer and FlushAllPgsImp to finish the writes they have in flight, if any. A miss that
+   * found no victim retries afterwards: the frames they have pinned may have been the only ones it could evict.
+   * @param lock the caller's lock on latch_, released while waiting
+   * @return false if no write was in flight
+   */
+  auto WaitForCleaning(std::unique_lock<TimedMutex> *lock) -> bool;
+
+  /**
+   * Reserve a frame for a page that is not resident: map it, pin it and mark it io_in_progress_. The caller has to do
+   * the I/O (DoPgIo) without latch_ and then call FinishPgIo. Requires latch_.
+   * @param page_id id of page to reserve a frame for, must not be resident or being written back
+   * @param strategy the access strategy of the miss
+   * @param[out] victim_page_id the dirty page that has to be written back first, or INVALID_PAGE_ID
+   * @param speculative true for read-ahead and prefetching, which must not push pages out of the pool (see GetPg)
+   * @return the reserved frame, or -1 if every frame is pinned
+   */
+  auto ReservePg(page_id_t page_id, AccessStrategy strategy, page_id_t *victim_page_id, bool speculative = false)
+      -> frame_id_t;
+
+  /**
+   * FetchPgsImp, optionally on behalf of read-ahead or prefetching: speculative batches do not evict pages of the
+   * normal pool (see GetPg) and skip pages that are being read in by someone else.
+   */
+  void FetchPgs(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages, AccessStrategy strategy,
+                bool speculative);
+
+  /**
+   * Read a page that is not resident into a frame, writing back the frame's dirty victim first. latch_ is released
+   * during the I/O; concurrent fetches of the page wait for it through FindPgOrWait.
+   * @param page_id id of page to read, must not be resident or being written back
+   * @param strategy the access strategy of the miss
+   * @param lock the caller's lock on latch_
+   * @param[out] read_failed set if the page is not allocated, or could not be read or does not match its checksum; the
+   * frame is freed again
+   * @return the pinned frame holding the page, or -1 if every frame is pinned or the read failed
+   */
+  auto LoadPg(page_id_t page_id, AccessStrategy strategy, std::unique_lock<TimedMutex> *lock, bool *read_failed)
+      -> frame_id_t;
+
+  /**
+   * Feed a scan's fetch to the read-ahead detector. Once the scan is seen fetching this instance's pages in allocation
+   * order, the pages after the current one are queued for the read-ahead thread. The window starts at
+   * READ_AHEAD_MIN_DEPTH pages and doubles whenever the scan catches up with it (the page it asks for is still not
+   * resident), up to half of the sequential ring. The window is the scan's own, so scans that interleave their
+   * fetches are each read ahead; a jump only restarts the window of the scan that jumped. Requires latch_.
+   * @param page_id the page being fetched
+   * @param window the scan's window in this instance
+   */
+  void ReadAhead(page_id_t page_id, ScanHandle::Window *window);
+
+  /** Body of the read-ahead thread: loads queued pages in batches and leaves them unpinned. */
+  void RunReadAhead();
+
+  /**
+   * get free frame from the strategy's ring, free_list_ or replacer_. If the victim is dirty it is recorded in
+   * pages_in_writeback_ and the caller must write it back (without holding latch_) and then call FinishPgIo.
+   * @param[out] victim_page_id id of the dirty page that still has to be written back, or INVALID_PAGE_ID
+   * @param strategy the access strategy of the miss; the frame becomes part of that strategy's ring
+   * @param speculative never evict a page of the normal pool for this miss: a full ring only recycles its own frames,
+   * and a NORMAL miss only takes a free frame
+   * @return frame_id_t of the free frame in the buffer, claimed (pin count -1) and out of page_table_
+   */
+  auto GetPg(page_id_t *victim_page_id, AccessStrategy strategy = AccessStrategy::NORMAL, bool speculative = false)
+      -> frame_id_t;
+
+  /**
+   * Take the oldest frame of a full ring back for reuse, if nobody is using it.
+   * @param strategy SEQUENTIAL or BULK_WRITE
+   * @return the frame, removed from the replacer but still holding its old page, or -1
+   */
+  auto RecycleRingFrame(AccessStrategy strategy) -> frame_id_t;
+
+  /**
+   * Move a frame into the ring of the given strategy (or out of any ring for NORMAL), trimming the ring to its
+   * capacity. Frames trimmed off the ring become ordinary frames.
+   */
+  void SetFrameStrategy(frame_id_t frame_id, AccessStrategy strategy);
+
+  /** Construct the frames from pool_size_ up to pool_size and add them to free_list_. Requires latch_. */
+  void AddFrames(size_t pool_size);
+
+  /**
+   * Take the frame at the end of the pool out of use, moving its page to a free frame below pool_size or evicting it.
+   * Requires latch_.
+   * @param frame_id the frame to withdraw, pool_size_ - 1 or below if the frames after it were withdrawn already
+   * @param pool_size the size the pool is shrinking to
+   * @return false if the frame holds a pinned or dirty page
+   */
+  auto WithdrawFrame(frame_id_t frame_id, size_t pool_size) -> bool;
+
+  /** Give the data of the withdrawn frames from pool_size on back. Requires latch_. */
+  void ReleaseFrames(size_t pool_size);
+
+  /** @return the ring of a SEQUENTIAL or BULK_WRITE strategy and its capacity */
+  auto GetRing(AccessStrategy strategy, size_t *capacity) -> std::deque<frame_id_t> *;
+
+  /**
+   * Write back the dirty victim of a reserved frame and, if requested, read the new page into it. Must be called
+   * without holding latch_; the frame has to be pinned and marked io_in_progress_ by the caller.
+   * @param frame_id the reserved frame
+   * @param victim_page_id the page returned by GetPg, or INVALID_PAGE_ID
+   * @param read_page_id page to read into the frame, or INVALID_PAGE_ID to leave its contents alone
+   * @return false if the page could not be read or does not match its checksum
+   */
+  auto DoPgIo(frame_id_t frame_id, page_id_t victim_page_id, page_id_t read_page_id) -> bool;
+
+  /**
+   * Clear the I/O state set up for a reserved frame and wake up everyone waiting on it. Requires latch_.
+   * @param frame_id the reserved frame
+   * @param victim_page_id the page returned by GetPg, or INVALID_PAGE_ID
+   */
+  void FinishPgIo(frame_id_t frame_id, page_id_t victim_page_id);
+
+  /**
+   * FinishPgIo for a reserved frame whose page could not be read: the page is dropped and the frame put on the free
+   * list, so that waiters for the page find it missing. Requires latch_, and the caller's reservation must be the only
+   * pin left on the frame.
+   * @param frame_id the reserved frame
+   * @param victim_page_id the page returned by GetPg, or INVALID_PAGE_ID
+   */
+  void AbortPgIo(frame_id_t frame_id, page_id_t victim_page_id);
+
+  /**
+   * Body of the background writer thread. Whenever the share of dirty frames reaches background_writer_dirty_ratio it
+   * writes unpinned dirty frames back in page id order, one at a time and without holding latch_ during the write,
+   * until the pool is below the watermark again.
+   */
+  void RunBackgroundWriter();
+
+  /**
+   * Write back one dirty frame on behalf of the background writer or FlushPgImp. The frame is pinned (without telling
+   * the replacer, so its recency is kept) and read-latched for the duration of the write. Requires latch_ through lock.
+   * @param frame_id the frame to clean
+   * @param lock the caller's lock on latch_, released during the write
    */
-  auto GetPg() -> frame_id_t;
+  void CleanPg(frame_id_t frame_id, std::unique_lock<TimedMutex> *lock);
 
   /**
-   * Flush the contents of page to disk without a specific latch_
-   * @param page_id the page id of the page to be flushed.
+   * Write back a batch of dirty frames with one DiskManager::WritePages call. Like CleanPg, the frames are pinned
+   * during the write; each is read-latched only while it is copied out, so no two page latches are held at once.
+   * Pages that were evicted meanwhile are waited for until their write-back has reached disk.
+   * @param batch the pages and the frames they were found in, in page id order
    */
-  void FlushPg(page_id_t page_id);
+  void FlushBatch(const std::vector<std::pair<page_id_t, frame_id_t>> &batch);
 };
 }  // namespace bustub
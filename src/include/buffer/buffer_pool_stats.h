@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+/**
+ * A snapshot of the counters of one buffer pool instance, or their sum over several. The counters only grow; the rate
+ * of anything is the difference between two snapshots.
+ */
+struct BufferPoolStats {
+  /** The index of the instance in its parallel buffer pool, 0 for a standalone instance and for sums. */
+  uint32_t instance_index_{0};
+  /** The number of frames. */
+  size_t pool_size_{0};
+  /** Fetches of pages that were already in the pool. */
+  uint64_t hits_{0};
+  /** Fetches that had to read the page from disk. */
+  uint64_t misses_{0};
+  /** Pages read in by read-ahead or PrefetchPages rather than on demand. */
+  uint64_t prefetches_{0};
+  /** Pages that lost their frame to another page. */
+  uint64_t evictions_{0};
+  /** Dirty victims written back by the fetch that evicted them. */
+  uint64_t eviction_writes_{0};
+  /** Dirty pages written back by the background writer. */
+  uint64_t background_writes_{0};
+  /** Acquisitions of the instance latch that had to wait, and the total time spent waiting in nanoseconds. */
+  uint64_t latch_waits_{0};
+  uint64_t latch_wait_ns_{0};
+  /** Victim searches in the replacer, and the number of frames they looked at in total. */
+  uint64_t victim_searches_{0};
+  uint64_t victim_search_steps_{0};
+
+  /** @return the fraction of fetches that were hits, 0 if there were none */
+  auto HitRatio() const -> double {
+    uint64_t fetches = hits_ + misses_;
+    return fetches == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(fetches);
+  }
+
+  /** Add the counters of another instance. */
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats &;
+
+  /** @return the counters on one line */
+  auto ToString() const -> std::string;
+};
+
+/**
+ * A counter for paths that run on many threads at once without a latch. Each thread adds to one of several cache
+ * lines, so threads rarely contend on an increment; reading sums them up.
+ */
+class StripedCounter {
+ public:
+  /** Add to the counter. */
+  void Add(uint64_t value = 1) {
+    static thread_local const size_t stripe = std::hash<std::thread::id>{}(std::this_thread::get_id()) % NUM_STRIPES;
+    stripes_[stripe].value_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /** @return the sum of what was added so far */
+  auto Load() const -> uint64_t {
+    uint64_t sum = 0;
+    for (const auto &stripe : stripes_) {
+      sum += stripe.value_.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  static constexpr size_t NUM_STRIPES = 16;
+
+  struct alignas(64) Stripe {
+    std::atomic<uint64_t> value_{0};
+  };
+
+  std::array<Stripe, NUM_STRIPES> stripes_;
+};
+
+}  // namespace bustub
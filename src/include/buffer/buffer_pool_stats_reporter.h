@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats_reporter.h
+//
+// Identification: src/include/buffer/buffer_pool_stats_reporter.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * BufferPoolStatsReporter hands a snapshot of a buffer pool's counters, one entry per instance, to a callback every
+ * buffer_pool_stats_interval, e.g. to log them or feed them to a monitoring system. By default they are logged.
+ */
+class BufferPoolStatsReporter {
+ public:
+  using report_fn = std::function<void(const std::vector<BufferPoolStats> &)>;
+
+  /**
+   * Creates a new BufferPoolStatsReporter and starts its thread.
+   * @param buffer_pool_manager the buffer pool to report on
+   * @param report called with the counters of each instance
+   */
+  explicit BufferPoolStatsReporter(BufferPoolManager *buffer_pool_manager, report_fn report = LogStats);
+
+  /**
+   * Stops the thread.
+   */
+  ~BufferPoolStatsReporter();
+
+  /** Takes a snapshot and reports it now. */
+  void Report();
+
+  /** Logs the counters of each instance, one line per instance. */
+  static void LogStats(const std::vector<BufferPoolStats> &stats);
+
+ private:
+  /** Body of the reporter thread: calls Report every buffer_pool_stats_interval. */
+  void Run();
+
+  BufferPoolManager *buffer_pool_manager_;
+  report_fn report_;
+  /** Protects stop_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool stop_{false};
+  std::thread thread_;
+};
+
+}  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <list>
 #include <mutex>  // NOLINT
 #include <vector>
@@ -23,6 +24,11 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Each frame has one atomic state byte holding an "in replacer" flag and a reference bit. Pin and Unpin are a single
+ * atomic store to that byte and never take a lock, so they stay off the profile of hot-page workloads. Only Victim
+ * advances the clock hand; it holds latch_ (victims are serialized) and claims a frame with a compare-and-swap, so it
+ * never victimizes a frame that is concurrently being pinned.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -39,14 +45,38 @@ class ClockReplacer : public Replacer {
 
   auto Victim(frame_id_t *frame_id) -> bool override;
 
+  /** Skips frames that are not preferred during the first two sweeps of the hand. */
+  auto PreferredVictim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &is_preferred) -> bool override;
+
   void Pin(frame_id_t frame_id) override;
 
   void Unpin(frame_id_t frame_id) override;
 
+  /** Lists the frames in the order the hand reaches them, those whose reference bit is clear first. */
+  void GetEvictionOrder(std::vector<frame_id_t> *frame_ids) override;
+
+  /** @return the number of frames in the replacer; a relaxed snapshot when Pin/Unpin run concurrently */
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  /** The frame can be victimized. */
+  static constexpr uint8_t IN_REPLACER = 0x1;
+  /** The frame was unpinned since the hand last passed it. */
+  static constexpr uint8_t REFERENCED = 0x2;
+
+  /**
+   * Sweep the hand until a frame can be claimed.
+   * @param[out] frame_id the victim
+   * @param is_preferred if not null, frames it rejects are only taken once two sweeps found nothing better
+   */
+  auto Sweep(frame_id_t *frame_id, const std::function<bool(frame_id_t)> *is_preferred) -> bool;
+
+  /** state byte of each frame, indexed by frame id */
+  std::vector<std::atomic<uint8_t>> states_;
+  /** position of the clock hand, only touched under latch_ */
+  size_t hand_{0};
+  /** serializes Victim */
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.h
+//
+// Identification: src/include/buffer/extent_allocator.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/page_router.h"
+#include "common/config.h"
+#include "storage/disk/free_space_map.h"
+
+namespace bustub {
+
+/**
+ * ExtentAllocator hands out and takes back the page ids of one buffer pool instance, recording them in the database's
+ * FreeSpaceMap. It works on the instance's local indexes (see PageRouter), grouped into extents of EXTENT_SIZE pages;
+ * with an ExtentPageRouter those are extents of adjacent pages in the database file.
+ *
+ * A page without a hint takes the lowest free page, which keeps small objects packed together and reuses freed pages.
+ * A page allocated near another page of the same table or index goes into that page's extent if it has room, and
+ * otherwise starts an empty extent, so a large object grows in extents of its own and scans it sequentially.
+ *
+ * Not thread-safe: the instance calls it under its latch.
+ */
+class ExtentAllocator {
+ public:
+  /**
+   * Create the allocator of an instance, picking up the pages of the instance that the map has allocated.
+   * @param free_space_map the map of the database
+   * @param router the routing of the parallel buffer pool
+   * @param instance_index the instance whose pages to allocate
+   */
+  ExtentAllocator(FreeSpaceMap *free_space_map, const PageRouter *router, uint32_t instance_index);
+
+  /**
+   * Allocate a page.
+   * @param near_page_id a page of the same object, INVALID_PAGE_ID (or a page of another instance) for none
+   * @param[out] new_extent set to true if the page is the first of an extent that was empty
+   * @return the page id
+   */
+  auto Allocate(page_id_t near_page_id, bool *new_extent) -> page_id_t;
+
+  /**
+   * Free a page. Freeing a page that is not allocated does nothing.
+   * @param page_id the page
+   */
+  void Free(page_id_t page_id);
+
+  /**
+   * The range of page ids an extent of this instance spans, to preallocate it.
+   * @param page_id a page of the extent
+   * @param[out] first_page_id the lowest page id of the extent
+   * @param[out] end_page_id one past the highest page id of the extent
+   */
+  void GetExtentRange(page_id_t page_id, page_id_t *first_page_id, page_id_t *end_page_id) const;
+
+  /**
+   * @param local_index a local index of the instance
+   * @return true if the page with that local index is allocated
+   */
+  auto IsAllocated(page_id_t local_index) const -> bool;
+
+ private:
+
+  /** Mark a free local index allocated. */
+  void Take(page_id_t local_index);
+
+  FreeSpaceMap *free_space_map_;
+  const PageRouter *router_;
+  const uint32_t instance_index_;
+  /** Number of allocated pages per extent of local indexes. */
+  std::vector<uint32_t> extent_used_;
+  /** No local index below this one is free. */
+  page_id_t first_free_{0};
+};
+
+}  // namespace bustub
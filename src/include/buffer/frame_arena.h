@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the memory of one buffer pool instance in two separate areas: the page data of every frame, and
+ * an array of frame descriptors (the Page objects) that only hold metadata, so a scan over the descriptors does not
+ * drag page data through the cache.
+ *
+ * The data area is backed by 2 MB huge pages if the system has some reserved (MAP_HUGETLB), and otherwise by regular
+ * pages aligned to 2 MB and marked for transparent huge pages, which keeps TLB misses down for large pools. Both areas
+ * are reserved for the largest the pool can grow to; memory is only committed when it is touched, and Release gives
+ * the data of retired frames back. Given a NUMA node, both areas prefer that node's memory.
+ */
+class FrameArena {
+ public:
+  /**
+   * Reserve the memory of a buffer pool.
+   * @param num_frames the number of frames the pool can grow to
+   * @param descriptor_size the size of a frame descriptor
+   * @param numa_node the NUMA node to place the memory on, -1 for the default policy
+   */
+  FrameArena(size_t num_frames, size_t descriptor_size, int numa_node = -1);
+
+  ~FrameArena();
+
+  FrameArena(const FrameArena &) = delete;
+  auto operator=(const FrameArena &) -> FrameArena & = delete;
+
+  /** @return the start of the frame descriptor array, aligned to a cache line */
+  auto GetDescriptors() -> void * { return descriptors_; }
+
+  /** @return the PAGE_SIZE bytes of data of a frame */
+  auto GetFrameData(size_t frame_id) -> char * { return data_ + frame_id * PAGE_SIZE; }
+
+  /**
+   * Give the data memory of a range of frames back to the OS. The range reads as zeros afterwards.
+   * @param begin the first frame
+   * @param end one past the last frame
+   */
+  void Release(size_t begin, size_t end);
+
+  /** @return true if the data area is backed by reserved huge pages */
+  auto UsesHugePages() const -> bool { return huge_pages_; }
+
+  /** @return the number of NUMA nodes of the machine, 1 if that cannot be found out */
+  static auto NumNumaNodes() -> int;
+
+ private:
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /** The mapping backing the data area and its length. */
+  void *data_mapping_;
+  size_t data_mapping_size_;
+  /** The page data of the frames, aligned to HUGE_PAGE_SIZE. */
+  char *data_;
+  /** The frame descriptors and their mapping's length. */
+  void *descriptors_;
+  size_t descriptors_size_;
+  bool huge_pages_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy (O'Neil et al., SIGMOD '93).
+ *
+ * Every Pin is an access stamped with a logical timestamp. The replacer keeps the last K uncorrelated access
+ * timestamps of each frame and evicts the evictable frame whose K-th most recent access is the oldest, i.e. the one
+ * with the largest backward K-distance. Frames with fewer than K recorded accesses have an infinite backward
+ * K-distance and are evicted first, oldest first access first, so a single sequential scan cannot push out pages that
+ * have been referenced repeatedly.
+ *
+ * An access that comes within correlated_period ticks of the frame's previous access is correlated (e.g. an operator
+ * pinning the same page once per tuple) and only refreshes the last access time instead of counting as a new one.
+ * The replacer does not know which operator an access comes from: the clock is shared by all of them and ticks on
+ * every Pin of any frame, so the period is the number of accesses to the pool in between, whoever made them. Under
+ * concurrent operators a re-reference of one operator is only seen as correlated if few enough accesses of the others
+ * fell in between.
+ *
+ * The evictable frames are kept in a set ordered by eviction priority, so Victim, Pin, Unpin and Remove take
+ * O(log n) time in the number of evictable frames.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses to remember per frame
+   * @param correlated_period accesses within this many ticks of the previous access are treated as correlated
+   */
+  LRUKReplacer(size_t num_pages, size_t k, size_t correlated_period = 0);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  auto Victim(frame_id_t *frame_id) -> bool override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  /** Lists the frames by decreasing backward K-distance, the order Victim takes them in. */
+  void GetEvictionOrder(std::vector<frame_id_t> *frame_ids) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+ private:
+  /** Access history of one frame. */
+  struct FrameHistory {
+    /** timestamps of the last (up to) k uncorrelated accesses, oldest first */
+    std::deque<uint64_t> history_;
+    /** timestamp of the last access, correlated or not */
+    uint64_t last_access_{0};
+    /** whether the frame can currently be victimized */
+    bool evictable_{false};
+  };
+
+  /** Eviction priority of a frame: (finite backward K-distance, k-th most recent or first access, frame id). */
+  using EvictionKey = std::tuple<bool, uint64_t, frame_id_t>;
+
+  /** Record an access to frame_id at a new timestamp. Requires latch_. */
+  void RecordAccess(frame_id_t frame_id);
+
+  /** @return the eviction priority of a frame with a non-empty history. Requires latch_. */
+  auto GetEvictionKey(frame_id_t frame_id) const -> EvictionKey;
+
+  /** k of LRU-K */
+  const size_t k_;
+  /** correlated reference period, in ticks */
+  const size_t correlated_period_;
+  /** logical clock, advanced on every access */
+  uint64_t current_timestamp_{0};
+  /** per frame access history, indexed by frame id */
+  std::vector<FrameHistory> frames_;
+  /** the evictable frames, in the order Victim takes them: infinite backward K-distances first, then the oldest */
+  std::set<EvictionKey> evictable_frames_;
+  std::mutex latch_{};
+};
+
+}  // namespace bustub
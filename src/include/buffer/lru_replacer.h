@@ -40,10 +40,16 @@ class LRUReplacer : public Replacer {
 
   auto Victim(frame_id_t *frame_id) -> bool override;
 
+  /** Evicts the least recently used preferred frame among the oldest quarter of the list, else the LRU frame. */
+  auto PreferredVictim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &is_preferred) -> bool override;
+
   void Pin(frame_id_t frame_id) override;
 
   void Unpin(frame_id_t frame_id) override;
 
+  /** Lists the frames from least to most recently used. */
+  void GetEvictionOrder(std::vector<frame_id_t> *frame_ids) override;
+
   auto Size() -> size_t override;
 
  private:
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_pressure_controller.h
+//
+// Identification: src/include/buffer/memory_pressure_controller.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * MemoryPressureController resizes a buffer pool to the memory the machine can spare, so the pool does not have to be
+ * sized for the peak when other processes share the machine.
+ *
+ * Every memory_pressure_interval it looks at the available memory. Below low_watermark bytes the pool immediately
+ * gives back enough frames (in multiples of BUFFER_POOL_CHUNK_SIZE) to get back above it. Above high_watermark bytes
+ * the pool grows by one chunk, as long as that leaves at least high_watermark bytes available. The pool is never
+ * resized beyond [min_pool_size, max_pool_size].
+ */
+class MemoryPressureController {
+ public:
+  /**
+   * Creates a new MemoryPressureController and starts its thread.
+   * @param buffer_pool_manager the buffer pool to resize
+   * @param min_pool_size the smallest pool size to shrink to
+   * @param max_pool_size the largest pool size to grow to
+   * @param low_watermark the pool shrinks while less than this many bytes are available
+   * @param high_watermark the pool grows while more than this many bytes are available
+   * @param available_memory returns the number of bytes available, ReadAvailableMemory by default
+   */
+  MemoryPressureController(BufferPoolManager *buffer_pool_manager, size_t min_pool_size, size_t max_pool_size,
+                           size_t low_watermark, size_t high_watermark,
+                           std::function<size_t()> available_memory = ReadAvailableMemory);
+
+  /**
+   * Stops the thread. The pool keeps its current size.
+   */
+  ~MemoryPressureController();
+
+  /**
+   * Resizes the pool once, according to the memory available right now.
+   * @return the pool size afterwards
+   */
+  auto Adjust() -> size_t;
+
+  /** @return MemAvailable of /proc/meminfo in bytes, or SIZE_MAX if it cannot be read */
+  static auto ReadAvailableMemory() -> size_t;
+
+ private:
+  /** Body of the controller thread: calls Adjust every memory_pressure_interval. */
+  void Run();
+
+  BufferPoolManager *buffer_pool_manager_;
+  const size_t min_pool_size_;
+  const size_t max_pool_size_;
+  const size_t low_watermark_;
+  const size_t high_watermark_;
+  std::function<size_t()> available_memory_;
+  /** Protects stop_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool stop_{false};
+  std::thread thread_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_router.h
+//
+// Identification: src/include/buffer/page_router.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** The ways a parallel buffer pool can spread pages over its instances. */
+enum class RoutingType { MODULO, EXTENT };
+
+/**
+ * PageRouter decides which instance of a parallel buffer pool a page belongs to. Every instance allocates the ids of
+ * its new pages itself, so the routing is a one-to-one mapping between page ids and (instance, local index) pairs:
+ * the k-th page an instance allocates is GetPageId(instance, k).
+ */
+class PageRouter {
+ public:
+  /**
+   * Create a router of the given type.
+   * @param routing_type the type of router
+   * @param num_instances the number of instances to route to
+   */
+  static auto Create(RoutingType routing_type, uint32_t num_instances) -> std::unique_ptr<PageRouter>;
+
+  explicit PageRouter(uint32_t num_instances) : num_instances_(num_instances) {}
+  virtual ~PageRouter() = default;
+
+  /** @return the instance responsible for a page */
+  virtual auto GetInstance(page_id_t page_id) const -> uint32_t = 0;
+
+  /** @return the position of a page among the pages of its instance, in allocation order */
+  virtual auto GetLocalIndex(page_id_t page_id) const -> page_id_t = 0;
+
+  /** @return the page at a position among the pages of an instance */
+  virtual auto GetPageId(uint32_t instance_index, page_id_t local_index) const -> page_id_t = 0;
+
+  /** @return the number of instances */
+  auto GetNumInstances() const -> uint32_t { return num_instances_; }
+
+ protected:
+  const uint32_t num_instances_;
+};
+
+/**
+ * Deals the pages out one at a time: page_id % num_instances. Consecutive pages of a table or index end up on
+ * alternating instances.
+ */
+class ModuloPageRouter : public PageRouter {
+ public:
+  explicit ModuloPageRouter(uint32_t num_instances) : PageRouter(num_instances) {}
+
+  auto GetInstance(page_id_t page_id) const -> uint32_t override;
+  auto GetLocalIndex(page_id_t page_id) const -> page_id_t override;
+  auto GetPageId(uint32_t instance_index, page_id_t local_index) const -> page_id_t override;
+};
+
+/**
+ * Deals the pages out an extent of EXTENT_SIZE consecutive pages at a time, so a run of pages one instance allocates
+ * (e.g. a table heap growing) stays together: a scan over it is served by one instance and its read-ahead.
+ */
+class ExtentPageRouter : public PageRouter {
+ public:
+  explicit ExtentPageRouter(uint32_t num_instances) : PageRouter(num_instances) {}
+
+  auto GetInstance(page_id_t page_id) const -> uint32_t override;
+  auto GetLocalIndex(page_id_t page_id) const -> page_id_t override;
+  auto GetPageId(uint32_t instance_index, page_id_t local_index) const -> page_id_t override;
+};
+
+}  // namespace bustub
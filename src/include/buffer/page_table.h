@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the page ids resident in one buffer pool instance to their frames.
+ *
+ * It is an open-addressing hash table with linear probing whose slots are single 64-bit atomics holding both the page
+ * id and the frame id, so a lookup never sees a torn entry. Lookups take no lock. Insert and Erase must be serialized
+ * by the caller (the buffer pool latch); Erase shifts the following entries back instead of leaving tombstones, which
+ * means a concurrent lookup can miss a page that is resident. A lookup that finds an entry can still race with the
+ * frame being reassigned, so lock-free callers have to validate the frame (pin it, then check its page id) and fall
+ * back to a lookup under the latch on a miss.
+ */
+class PageTable {
+ public:
+  /**
+   * Create a new, empty page table.
+   * @param num_frames the number of frames of the buffer pool, i.e. the maximum number of entries
+   */
+  explicit PageTable(size_t num_frames);
+
+  /**
+   * Look up a page. Safe to call concurrently with everything, see the class comment for what a result means then.
+   * @param page_id the page to look up
+   * @return the frame that holds (or very recently held) the page, or -1
+   */
+  auto Find(page_id_t page_id) const -> frame_id_t;
+
+  /**
+   * Add a page that is not in the table yet; adding one that is fails an assertion. Must not run concurrently with
+   * Insert or Erase.
+   * @param page_id the page
+   * @param frame_id the frame holding it
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove a page if it is in the table. Must not run concurrently with Insert or Erase.
+   * @param page_id the page
+   */
+  void Erase(page_id_t page_id);
+
+ private:
+  /** An entry with INVALID_PAGE_ID and frame -1 marks an empty slot. */
+  static constexpr uint64_t EMPTY_SLOT = ~uint64_t{0};
+
+  static auto MakeSlot(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto SlotPageId(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto SlotFrameId(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the slot a page's probe sequence starts at */
+  auto HomeSlot(page_id_t page_id) const -> size_t;
+
+  /** The slots, a power of two at least twice the number of frames so probe sequences stay short. */
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  /** Number of slots minus one. */
+  size_t mask_;
+};
+
+}  // namespace bustub
@@ -12,10 +12,13 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_router.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
@@ -30,12 +33,17 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every BufferPoolManagerInstance
+   * @param max_pool_size the pool size each BufferPoolManagerInstance can grow to, 0 for pool_size
+   * @param routing_type how page ids are spread over the BufferPoolManagerInstances
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU,
+                            size_t max_pool_size = 0, RoutingType routing_type = RoutingType::MODULO);
 
   /**
-   * Destroys an existing ParallelBufferPoolManager.
+   * Destroys an existing ParallelBufferPoolManager and its instances, which write back their dirty pages. Like an
+   * instance, it must be destroyed before its disk manager is shut down.
    */
   ~ParallelBufferPoolManager() override;
 
@@ -49,6 +57,13 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager *;
 
+  /**
+   * Split a list of page ids by the instance owning them.
+   * @param page_ids the page ids
+   * @return for every instance, the positions in page_ids of its pages
+   */
+  auto GroupByInstance(const std::vector<page_id_t> &page_ids) -> std::vector<std::vector<size_t>>;
+
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
@@ -56,6 +71,52 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
+  /**
+   * Fetch the requested page from the buffer pool on behalf of an access with the given strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy how the caller is going to access this and the following pages
+   * @return the requested page
+   */
+  auto FetchPgImp(page_id_t page_id, AccessStrategy strategy) -> Page * override;
+
+  /**
+   * Fetch the requested page for a sequential scan from its instance, which reads ahead for the scan.
+   * @param page_id id of page to be fetched
+   * @param scan the read-ahead state of the scan
+   * @return the requested page
+   */
+  auto FetchScanPgImp(page_id_t page_id, ScanHandle *scan) -> Page * override;
+
+  /**
+   * Look up a resident page for an optimistic read, without pinning it or taking any latch.
+   * @param page_id id of page to be read
+   * @param[out] version the page's version when the read started
+   * @return the page, or nullptr if it is not resident or is being written
+   */
+  auto OptimisticFetchPgImp(page_id_t page_id, uint64_t *version) -> Page * override;
+
+  /**
+   * Pin a page through a swizzled reference, in the instance responsible for page_id.
+   * @param page the frame the reference points to
+   * @param page_id the page the reference stands for
+   * @return the page, or nullptr if the frame no longer holds it
+   */
+  auto FetchSwizzledPgImp(Page *page, page_id_t page_id) -> Page * override;
+
+  /**
+   * Record the owner of the swizzled references to a pinned page, in the instance the page belongs to.
+   * @param page a pinned page
+   * @param owner the owner of the references
+   * @return false if the page may not be swizzled
+   */
+  auto SwizzlePgImp(Page *page, SwizzleOwner *owner) -> bool override;
+
+  /**
+   * Drop an owner from the frames of all instances.
+   * @param owner the owner of the references
+   */
+  void UnswizzleAllImp(SwizzleOwner *owner) override;
+
   /**
    * Unpin the target page from the buffer pool.
    * @param page_id id of page to be unpinned
@@ -64,6 +125,23 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
 
+  /**
+   * Fetch several pages at once: the page ids are grouped by owning instance and each group is fetched as one batch.
+   * @param page_ids ids of the pages to fetch
+   * @param[out] pages the fetched pages, nullptr where a page could not be fetched
+   * @param strategy how the caller is going to access the pages
+   */
+  void FetchPgsImp(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages,
+                   AccessStrategy strategy) override;
+
+  /**
+   * Unpin several pages at once, grouped by owning instance.
+   * @param page_ids ids of the pages to unpin
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if any of the pages was not resident or not pinned
+   */
+  auto UnpinPgsImp(const std::vector<page_id_t> &page_ids, bool is_dirty) -> bool override;
+
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
@@ -72,12 +150,23 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   auto FlushPgImp(page_id_t page_id) -> bool override;
 
   /**
-   * Creates a new page in the buffer pool.
+   * Creates a new page in the buffer pool. Every thread allocates from a home instance, an extent of EXTENT_SIZE pages
+   * at a time, so the pages one thread creates in a row share an instance. Another instance is used when the home
+   * instance has no free frame and the other one does, or when every frame of the home instance is pinned.
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
   auto NewPgImp(page_id_t *page_id) -> Page * override;
 
+  /**
+   * Creates a new page in the instance owning near_page_id, which places it in the same extent if it can. If that
+   * instance has every frame pinned, the page is created as by NewPgImp.
+   * @param near_page_id a page of the same object, INVALID_PAGE_ID for none
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgNearImp(page_id_t near_page_id, page_id_t *page_id) -> Page * override;
+
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
@@ -90,9 +179,40 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    */
   void FlushAllPgsImp() override;
 
+  /**
+   * Grows or shrinks every BufferPoolManagerInstance by its share of the change. The number of instances stays the
+   * same: page ids are striped across the instances, so adding or removing one would move most pages to another.
+   * @param pool_size the total number of frames the pool should have
+   * @return the total number of frames the pool has afterwards
+   */
+  auto ResizePoolImp(size_t pool_size) -> size_t override;
+
+  /**
+   * Merges the lists of the instances by rank: the hottest page of each instance, then the second hottest, and so on.
+   * @param[out] page_ids the page ids
+   */
+  void GetResidentPgsImp(std::vector<page_id_t> *page_ids) override;
+
+  /**
+   * Hands every instance its share of the pages.
+   * @param page_ids the pages to read
+   * @return the number of pages that were read in
+   */
+  auto PrefetchPgsImp(const std::vector<page_id_t> &page_ids) -> size_t override;
+
+  /**
+   * Collect the counters of all instances, in instance order, so skew between them shows.
+   * @param[out] stats one entry per instance
+   */
+  void GetStatsImp(std::vector<BufferPoolStats> *stats) override;
+
  private:
+  /** Identifies this pool to the threads' home instances, see NewPgImp. */
+  const uint64_t pool_id_;
+  /** The home instance of the next thread to create a page. */
+  std::atomic<uint32_t> next_home_index_{0};
+  /** Maps page ids to the instances, shared by all of them. */
+  std::unique_ptr<PageRouter> router_;
   std::vector<BufferPoolManagerInstance *> bpmis_;
-  uint32_t last_alloc_index_{0};
-  size_t pool_size_;
 };
 }  // namespace bustub
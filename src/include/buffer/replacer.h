@@ -12,10 +12,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies a buffer pool instance can be constructed with. */
+enum class ReplacerType { LRU, LRU_K, CLOCK };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -31,6 +38,17 @@ class Replacer {
    */
   virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
 
+  /**
+   * Remove a victim frame, preferring one for which is_preferred returns true (e.g. a clean frame) over the frame the
+   * replacement policy would pick on its own. Policies that cannot search cheaply may ignore the preference.
+   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
+   * @param is_preferred predicate selecting the frames that should be evicted first
+   * @return true if a victim frame was found, false otherwise
+   */
+  virtual auto PreferredVictim(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &is_preferred) -> bool {
+    return Victim(frame_id);
+  }
+
   /**
    * Pins a frame, indicating that it should not be victimized until it is unpinned.
    * @param frame_id the id of the frame to pin
@@ -43,8 +61,29 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Removes a frame from the replacer and forgets its access history, as if it had been victimized. Used when the
+   * buffer pool reuses or frees a frame without asking for a victim.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * List the frames that can be victimized in the order the policy would evict them, next victim first. The buffer
+   * pool uses it as a recency hint when it saves its contents. The default knows no order and lists nothing.
+   * @param[out] frame_ids the frames
+   */
+  virtual void GetEvictionOrder(std::vector<frame_id_t> *frame_ids) { frame_ids->clear(); }
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
+
+  /** @return the number of frames all victim searches so far have looked at */
+  auto GetVictimSearchSteps() const -> uint64_t { return victim_search_steps_.load(std::memory_order_relaxed); }
+
+ protected:
+  /** Added to by the victim searches of the policies. */
+  std::atomic<uint64_t> victim_search_steps_{0};
 };
 
 }  // namespace bustub
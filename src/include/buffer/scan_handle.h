@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// scan_handle.h
+//
+// Identification: src/include/buffer/scan_handle.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * The read-ahead detector of one sequential scan, passed along with its fetches (see BufferPoolManager::FetchScanPage)
+ * so that scans interleaving their fetches on one buffer pool are each read ahead on their own. A scan walks the pages
+ * of each buffer pool instance in allocation order, so it keeps one window per instance. A handle belongs to one scan
+ * and is only used by the thread running it.
+ */
+class ScanHandle {
+ public:
+  /** The read-ahead window of a scan in one buffer pool instance. */
+  struct Window {
+    /** The last page the scan fetched from the instance. */
+    page_id_t last_page_id_{INVALID_PAGE_ID};
+    /** Number of pages the scan is read ahead by, between READ_AHEAD_MIN_DEPTH and READ_AHEAD_MAX_DEPTH. */
+    int depth_{READ_AHEAD_MIN_DEPTH};
+    /** The local index of the next page of the scan that has not been queued for read-ahead yet. */
+    page_id_t next_index_{0};
+  };
+
+  /**
+   * @param instance_index the index of a buffer pool instance in its parallel buffer pool, 0 for a standalone one
+   * @return the scan's window in the instance
+   */
+  auto GetWindow(uint32_t instance_index) -> Window * {
+    if (instance_index >= windows_.size()) {
+      windows_.resize(instance_index + 1);
+    }
+    return &windows_[instance_index];
+  }
+
+ private:
+  std::vector<Window> windows_;
+};
+
+}  // namespace bustub
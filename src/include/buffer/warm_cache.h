@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// warm_cache.h
+//
+// Identification: src/include/buffer/warm_cache.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * WarmCache carries the contents of a buffer pool across restarts, so a restarted database does not start out cold.
+ *
+ * A dump thread saves the ids of the resident pages, hottest first (see BufferPoolManager::GetResidentPages), to a
+ * small side file every warm_cache_dump_interval and once more when the WarmCache is destroyed. When a WarmCache is
+ * created and the file exists, a loader thread reads the hottest pages that fit into the pool back in, in page id
+ * order, while the pool already serves requests. It only fills free frames, so it never evicts a page that live
+ * traffic brought in.
+ *
+ * The file is a header (WARM_CACHE_MAGIC and the number of pages) followed by the page ids. It is written to a
+ * temporary file first and renamed over the old one, so a crash while dumping leaves the previous list intact.
+ */
+class WarmCache {
+ public:
+  /**
+   * Creates a new WarmCache and starts warming up the pool from the file, if there is one.
+   * @param buffer_pool_manager the buffer pool to save and restore
+   * @param file_name the side file
+   */
+  WarmCache(BufferPoolManager *buffer_pool_manager, std::string file_name);
+
+  /**
+   * Stops the threads and saves the resident pages one last time, unless the pool is still warming up.
+   */
+  ~WarmCache();
+
+  /**
+   * Saves the ids of the resident pages now.
+   * @return false if the file could not be written
+   */
+  auto Dump() -> bool;
+
+  /**
+   * Waits until the pool has been warmed up.
+   * @return the number of pages the loader read in
+   */
+  auto WaitForLoad() -> size_t;
+
+  /**
+   * Reads a file written by Dump.
+   * @param file_name the file
+   * @param[out] page_ids the page ids, hottest first
+   * @return false if the file does not exist or is not a warm cache file
+   */
+  static auto ReadFile(const std::string &file_name, std::vector<page_id_t> *page_ids) -> bool;
+
+ private:
+  static constexpr uint32_t WARM_CACHE_MAGIC = 0x43575442;  // "BTWC"
+
+  /** Body of the loader thread. */
+  void Load();
+
+  /** Body of the dump thread. */
+  void RunDump();
+
+  BufferPoolManager *buffer_pool_manager_;
+  std::string file_name_;
+  /** Protects stop_, loaded_ and num_loaded_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool stop_{false};
+  bool loaded_{false};
+  size_t num_loaded_{0};
+  std::thread loader_;
+  std::thread dumper_;
+};
+
+}  // namespace bustub
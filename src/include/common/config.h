@@ -27,6 +27,21 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** Each buffer pool instance's background writer wakes up every BACKGROUND_WRITER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds background_writer_interval;
+
+/** The background writer cleans unpinned frames once more than this fraction of a buffer pool instance is dirty. */
+extern std::atomic<double> background_writer_dirty_ratio;
+
+/** A memory pressure controller checks the memory available to its buffer pool every MEMORY_PRESSURE_INTERVAL ms. */
+extern std::chrono::milliseconds memory_pressure_interval;
+
+/** A warm cache saves the page ids resident in its buffer pool every WARM_CACHE_DUMP_INTERVAL milliseconds. */
+extern std::chrono::milliseconds warm_cache_dump_interval;
+
+/** A buffer pool stats reporter takes a snapshot of its buffer pool's counters every BUFFER_POOL_STATS_INTERVAL ms. */
+extern std::chrono::milliseconds buffer_pool_stats_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
@@ -35,6 +50,17 @@ static constexpr int PAGE_SIZE = 4096;                                        //
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // k of the buffer pool's LRU-K replacer
+static constexpr int LRUK_CORRELATED_PERIOD = 8;                              // LRU-K correlated period, in pins
+static constexpr int SEQUENTIAL_RING_SIZE = 32;                               // max frames a sequential scan cycles
+static constexpr int BULK_WRITE_RING_SIZE = 32;                               // max frames a bulk write cycles
+static constexpr int READ_AHEAD_MIN_DEPTH = 2;                                // initial read-ahead window in pages
+static constexpr int READ_AHEAD_MAX_DEPTH = 16;                               // max read-ahead window in pages
+static constexpr int BUFFER_POOL_CHUNK_SIZE = 64;                             // frames a pool grows by at a time
+static constexpr int EXTENT_SIZE = 64;                                        // pages per extent
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;                               // max async disk I/Os in flight
+static constexpr int ASYNC_IO_THREADS = 4;                                    // threads of the async I/O fallback
+static constexpr int FLUSH_BATCH_SIZE = 256;                                  // max pages written back per batch
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// timed_mutex.h
+//
+// Identification: src/include/common/timed_mutex.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+/**
+ * A std::mutex that keeps count of how often and for how long lock() had to wait for another thread. An uncontended
+ * lock() costs one try_lock more than a plain std::mutex; the clock is only read when the mutex is taken.
+ * Use it with std::condition_variable_any.
+ */
+class TimedMutex {
+ public:
+  void lock() {  // NOLINT
+    if (mutex_.try_lock()) {
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    mutex_.lock();
+    auto wait = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    waits_.fetch_add(1, std::memory_order_relaxed);
+    wait_ns_.fetch_add(wait.count(), std::memory_order_relaxed);
+  }
+
+  auto try_lock() -> bool { return mutex_.try_lock(); }  // NOLINT
+
+  void unlock() { mutex_.unlock(); }  // NOLINT
+
+  /** @return the number of times lock() had to wait */
+  auto GetWaits() const -> uint64_t { return waits_.load(std::memory_order_relaxed); }
+
+  /** @return the total time lock() spent waiting, in nanoseconds */
+  auto GetWaitTime() const -> uint64_t { return wait_ns_.load(std::memory_order_relaxed); }
+
+ private:
+  std::mutex mutex_;
+  std::atomic<uint64_t> waits_{0};
+  std::atomic<uint64_t> wait_ns_{0};
+};
+
+}  // namespace bustub
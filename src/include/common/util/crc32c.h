@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c.h
+//
+// Identification: src/include/common/util/crc32c.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32c computes the CRC-32C (Castagnoli) checksum, which catches the bit flips and torn writes that corrupt a page
+ * on its way to disk and back. It uses the SSE4.2 crc32 instruction where the CPU has it (well over 10 GB/s, a
+ * fraction of a microsecond per page) and a slicing-by-8 table everywhere else; both compute the same checksum.
+ */
+class Crc32c {
+ public:
+  /**
+   * @param data the bytes to checksum
+   * @param size the number of bytes
+   * @param crc the checksum of the bytes before data, to checksum a buffer in pieces
+   * @return the checksum of the bytes so far
+   */
+  static auto Compute(const char *data, size_t size, uint32_t crc = 0) -> uint32_t;
+
+  /** Compute with the table, whatever the CPU supports. */
+  static auto ComputeWithTable(const char *data, size_t size, uint32_t crc = 0) -> uint32_t;
+
+  /** @return true if Compute uses the crc32 instruction */
+  static auto IsHardwareAccelerated() -> bool;
+};
+
+}  // namespace bustub
@@ -13,8 +13,12 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -22,6 +26,8 @@
 #include "container/hash/hash_function.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_directory_root_page.h"
+#include "storage/page/hash_table_directory_segment_page.h"
 
 namespace bustub {
 
@@ -31,9 +37,16 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * The directory spans directory pages listed by segment pages, which a root page lists in turn, so a lookup reads the
+ * root page, one segment page, one directory page and the bucket.
+ *
+ * With swizzling on, the table remembers the frame each directory slot's bucket was last found in and pins it
+ * directly next time, skipping the buffer pool's page table; the buffer pool drops the reference when it evicts the
+ * bucket.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
-class ExtendibleHashTable {
+class ExtendibleHashTable : public SwizzleOwner {
  public:
   /**
    * Creates a new ExtendibleHashTable.
@@ -41,9 +54,16 @@ class ExtendibleHashTable {
    * @param buffer_pool_manager buffer pool manager to be used
    * @param comparator comparator for keys
    * @param hash_fn the hash function
+   * @param swizzle true to keep swizzled references to the bucket pages; the table then has to be destroyed before
+   * the buffer pool
    */
   explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn, bool swizzle = false);
+
+  /**
+   * Drops the table's swizzled references from the buffer pool.
+   */
+  ~ExtendibleHashTable() override;
 
   /**
    * Inserts a key-value pair into the hash table.
@@ -55,6 +75,17 @@ class ExtendibleHashTable {
    */
   auto Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool;
 
+  /**
+   * Inserts many key-value pairs into an empty hash table at once. The pairs are sorted by hash, the directory is
+   * sized for them up front and every bucket page is written once, in order; the buckets come out the same as those
+   * of inserting the pairs one by one. A table that is not empty gets the pairs inserted one by one.
+   *
+   * @param transaction the current transaction
+   * @param entries the key-value pairs to insert
+   * @return true if every insert succeeded, false otherwise
+   */
+  auto BulkLoad(Transaction *transaction, const std::vector<std::pair<KeyType, ValueType>> &entries) -> bool;
+
   /**
    * Deletes the associated value for the given key.
    *
@@ -108,37 +139,157 @@ class ExtendibleHashTable {
    * representation.
    *
    * @param key the key to use for lookup
-   * @param dir_page to use for lookup of global depth
+   * @param root_page to use for lookup of global depth
    * @return the directory index
    */
-  inline auto KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t;
+  inline auto KeyToDirectoryIndex(KeyType key, HashTableDirectoryRootPage *root_page) -> uint32_t;
 
   /**
-   * Get the bucket page_id corresponding to a key.
+   * Get the bucket page_id corresponding to a key without pinning the directory: the root page and the directory page
+   * are each read optimistically and only fetched and read-latched if the optimistic read fails.
    *
    * @param key the key for lookup
-   * @param dir_page a pointer to the hash table's directory page
+   * @param[out] bucket_idx the directory index of the key
    * @return the bucket page_id corresponding to the input key
    */
-  inline auto KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t;
+  auto LookupBucketPageId(const KeyType &key, uint32_t *bucket_idx) -> page_id_t;
 
   /**
-   * Fetches the directory page from the buffer pool manager.
+   * Fetches the directory root page from the buffer pool manager.
    *
+   * @param[out] page if not nullptr, the buffer pool page holding the root (for latching it)
+   * @return a pointer to the directory root page
+   */
+  auto FetchRootPage(Page **page = nullptr) -> HashTableDirectoryRootPage *;
+
+  /**
+   * Fetches a directory page from the buffer pool manager using its page_id.
+   *
+   * @param directory_page_id the page_id to fetch
+   * @param[out] page if not nullptr, the buffer pool page holding the directory page (for latching it)
    * @return a pointer to the directory page
    */
-  auto FetchDirectoryPage() -> HashTableDirectoryPage *;
+  auto FetchDirectoryPage(page_id_t directory_page_id, Page **page = nullptr) -> HashTableDirectoryPage *;
+
+  /**
+   * Reads the page_id of a directory page from the segment page listing it, optimistically if possible.
+   *
+   * @param segment_page_id the page_id of the segment page
+   * @param directory_idx the index of the directory page
+   * @return the page_id of the directory page
+   */
+  auto ReadSegmentSlot(page_id_t segment_page_id, uint32_t directory_idx) -> page_id_t;
+
+  /**
+   * @param root_page the directory root page
+   * @param directory_idx the index of a directory page
+   * @return the page_id of the directory page
+   */
+  auto GetDirectoryPageId(HashTableDirectoryRootPage *root_page, uint32_t directory_idx) -> page_id_t;
+
+  /**
+   * Lists a new directory page in its segment page, adding the segment page to the root page if the directory page
+   * is the first of its segment. The table latch must be held in write mode.
+   *
+   * @param root_page the directory root page
+   * @param directory_idx the index of the directory page
+   * @param directory_page_id the page_id of the directory page
+   */
+  void AddDirectoryPage(HashTableDirectoryRootPage *root_page, uint32_t directory_idx, page_id_t directory_page_id);
 
   /**
    * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
    *
    * @param bucket_page_id the page_id to fetch
+   * @param[out] page if not nullptr, the buffer pool page holding the bucket (for latching it)
    * @return a pointer to a bucket page
    */
-  auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
+  auto FetchBucketPage(page_id_t bucket_page_id, Page **page = nullptr) -> HASH_TABLE_BUCKET_TYPE *;
 
   /**
-   * Performs insertion with an optional bucket splitting.
+   * Fetches the bucket page of a directory slot, through the slot's swizzled reference if it still holds.
+   *
+   * @param bucket_idx the directory index
+   * @param bucket_page_id the page_id the directory holds at bucket_idx
+   * @param[out] page the buffer pool page holding the bucket (for latching it)
+   * @return a pointer to a bucket page
+   */
+  auto FetchBucketPage(uint32_t bucket_idx, page_id_t bucket_page_id, Page **page) -> HASH_TABLE_BUCKET_TYPE *;
+
+  /**
+   * Fetches and latches the bucket page a key maps to. The directory is looked up again once the latch is held: a
+   * split that moves the key into another bucket changes the directory while holding the old bucket's write latch, so
+   * if the lookup still gives the same page, the bucket is the right one for as long as the latch is held.
+   *
+   * @param key the key for lookup
+   * @param exclusive true for a write latch, false for a read latch
+   * @param[out] bucket_page_id the page_id of the bucket
+   * @param[out] page the buffer pool page holding the bucket
+   * @return a pointer to the pinned and latched bucket page
+   */
+  auto FetchLatchedBucket(const KeyType &key, bool exclusive, page_id_t *bucket_page_id, Page **page)
+      -> HASH_TABLE_BUCKET_TYPE *;
+
+  /**
+   * Drops the swizzled references to a frame the buffer pool is about to reuse.
+   *
+   * @param page the frame
+   */
+  void Unswizzle(Page *page) override;
+
+  /**
+   * Reads a slot of the directory, read-latching the directory page that holds it.
+   *
+   * @param root_page the directory root page
+   * @param bucket_idx the directory index
+   * @param[out] bucket_page_id the bucket page_id at bucket_idx
+   * @return the local depth at bucket_idx
+   */
+  auto ReadDirectorySlot(HashTableDirectoryRootPage *root_page, uint32_t bucket_idx, page_id_t *bucket_page_id)
+      -> uint32_t;
+
+  /**
+   * Points every directory slot that agrees with bucket_idx in its low local_depth bits at a bucket, and sets their
+   * local depth to local_depth. Each directory page is write-latched while its slots change.
+   *
+   * @param root_page the directory root page
+   * @param bucket_idx a directory index of the bucket
+   * @param local_depth the local depth of the bucket
+   * @param bucket_page_id the page_id of the bucket
+   */
+  void SetBucketSlots(HashTableDirectoryRootPage *root_page, uint32_t bucket_idx, uint32_t local_depth,
+                      page_id_t bucket_page_id);
+
+  /**
+   * Doubles the directory. Once it outgrows a single directory page, the directory pages of the lower half are copied
+   * to new pages for the upper half, and segment pages are added as needed. The table latch must be held in write
+   * mode.
+   *
+   * @param root_page the directory root page
+   * @param raw_root_page the buffer pool page holding the root
+   */
+  void GrowDirectory(HashTableDirectoryRootPage *root_page, Page *raw_root_page);
+
+  /**
+   * @param root_page the directory root page
+   * @return true if no slot of the directory has a local depth equal to the global depth
+   */
+  auto CanShrink(HashTableDirectoryRootPage *root_page) -> bool;
+
+  /**
+   * Halves the directory for as long as it can shrink, deleting directory and segment pages it no longer needs. The
+   * table latch must be held in write mode.
+   *
+   * @param root_page the directory root page
+   * @param raw_root_page the buffer pool page holding the root
+   */
+  void ShrinkDirectory(HashTableDirectoryRootPage *root_page, Page *raw_root_page);
+
+  /**
+   * Performs insertion with an optional bucket splitting. A bucket whose local depth is below the global depth is
+   * split holding the table latch in read mode, the write latches of the directory pages it changes and the latches of
+   * the bucket and its split image. Only a split that has to double the directory takes the table latch in write mode.
+   * A split that leaves the key's bucket full is followed by another one.
    *
    * @param transaction a pointer to the current transaction
    * @param key the key to insert
@@ -148,13 +299,48 @@ class ExtendibleHashTable {
   auto SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool;
 
   /**
-   * Optionally merges an empty bucket into it's pair.  This is called by Remove,
-   * if Remove makes a bucket empty.
+   * Splits the key's bucket after doubling the directory if needed, holding the table latch in write mode. The
+   * insert fails if the directory is as large as it gets, or if no directory could tell the bucket's keys apart.
+   *
+   * @param transaction a pointer to the current transaction
+   * @param key the key to insert
+   * @param value the value to insert
+   * @param new_page the write-latched page to use as the split image, unpinned (and deleted if unused) on return
+   * @param new_bucket_page_id the page_id of new_page
+   * @return whether or not the insertion was successful
+   */
+  auto SplitInsertDoubling(Transaction *transaction, const KeyType &key, const ValueType &value, Page *new_page,
+                           page_id_t new_bucket_page_id) -> bool;
+
+  /**
+   * Points half of a full bucket's directory slots at its split image and moves the entries that now belong to the
+   * split image over. The directory must have room for the split.
+   *
+   * @param root_page the directory root page
+   * @param bucket_idx a directory index of the full bucket
+   * @param local_depth the local depth of the full bucket
+   * @param bucket_page_id the page_id of the full bucket
+   * @param bucket_page the write-latched full bucket
+   * @param new_bucket_page_id the page_id of the split image
+   * @param new_bucket_page the write-latched, empty split image
+   * @param key the key to insert
+   * @param value the value to insert
+   * @return whether or not the insertion was successful
+   */
+  auto SplitBucket(HashTableDirectoryRootPage *root_page, uint32_t bucket_idx, uint32_t local_depth,
+                   page_id_t bucket_page_id, HASH_TABLE_BUCKET_TYPE *bucket_page, page_id_t new_bucket_page_id,
+                   HASH_TABLE_BUCKET_TYPE *new_bucket_page, const KeyType &key, const ValueType &value) -> bool;
+
+  /**
+   * Optionally merges a bucket into it's pair, and the merged bucket into its own pair and so on.  This is called by
+   * Remove, if Remove makes a bucket empty or leaves it a quarter full. Merges run holding the table latch in read
+   * mode and the latches of the two buckets; if the directory can shrink afterwards, it is halved holding the table
+   * latch in write mode.
    *
    * There are three conditions under which we skip the merge:
-   * 1. The bucket is no longer empty.
-   * 2. The bucket has local depth 0.
-   * 3. The bucket's local depth doesn't match its split image's local depth.
+   * 1. The bucket has local depth 0.
+   * 2. The bucket's local depth doesn't match its split image's local depth.
+   * 3. The entries of both buckets don't fit into half a bucket.
    *
    * @param transaction a pointer to the current transaction
    * @param key the key that was removed
@@ -162,14 +348,55 @@ class ExtendibleHashTable {
    */
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
 
+  /**
+   * Merges the bucket of a key into its split image if the skip conditions of Merge allow it, moving its entries
+   * over and retiring its page (see DeleteRetiredPages). The table latch must be held in read mode and
+   * merge_latch_ held.
+   *
+   * @param root_page the directory root page
+   * @param key the key whose bucket to merge
+   * @param[in,out] shrink set if the merged buckets were as deep as the directory
+   * @return true if the bucket was merged
+   */
+  auto MergeBucket(HashTableDirectoryRootPage *root_page, const KeyType &key, bool *shrink) -> bool;
+
+  /**
+   * Deletes the pages of the buckets merged away, and the pages whose delete the buffer pool refused before. A thread
+   * that read a bucket's page id from the directory before the merge may still fetch it, and finds it is no longer the
+   * key's bucket only once it holds the page's latch; if the page were deleted, the id could be handed out for another
+   * page by then. All such threads hold the table latch in read mode, so the table latch must be held in write mode.
+   */
+  void DeleteRetiredPages();
+
+  /**
+   * Deletes a page nobody can look up any more. A page the buffer pool itself still has pinned, e.g. to write it back,
+   * is retired instead and deleted along with the merged away buckets.
+   *
+   * @param page_id the page to delete
+   */
+  void DeleteOrRetirePage(page_id_t page_id);
+
   // member variables
-  page_id_t directory_page_id_;
+  page_id_t root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writers are splits and merges
+  // Readers includes inserts, removes, merges and splits that don't resize the directory, writers are directory
+  // doublings and halvings
   ReaderWriterLatch table_latch_;
+  // Taken before table_latch_ by merges, one of which runs at a time
+  std::mutex merge_latch_;
+  // The pages of the buckets merged away and of the bucket, directory and segment pages the buffer pool refused to
+  // delete, deleted once the table latch is next held in write mode: at a directory doubling or halving, or after a
+  // merge if nobody else is in the table
+  std::mutex retired_latch_;
+  std::vector<page_id_t> retired_page_ids_;
   HashFunction<KeyType> hash_fn_;
+
+  bool swizzle_;
+  // the frame each directory slot's bucket was last pinned in, slots DIRECTORY_ARRAY_SIZE apart sharing an entry;
+  // only a hint, a pin through it checks the page id
+  std::array<std::atomic<Page *>, DIRECTORY_ARRAY_SIZE> bucket_frames_{};
 };
 
 }  // namespace bustub
@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io.h
+//
+// Identification: src/include/storage/disk/async_io.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <linux/io_uring.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * One asynchronous read or write of a file range.
+ */
+struct DiskRequest {
+  /** true for a write, false for a read */
+  bool is_write_;
+  /** the data to write or the buffer to read into, valid until the callback was called */
+  char *data_;
+  size_t size_;
+  off_t offset_;
+  /**
+   * Called from an engine thread once the request is done, with the number of bytes transferred (which can be short,
+   * like that of a pread or pwrite) or -errno.
+   */
+  std::function<void(ssize_t)> callback_;
+  /** Used by IoUringEngine, which needs an iovec that lives as long as the request. */
+  struct iovec iov_;
+};
+
+/**
+ * AsyncIoEngine runs the reads and writes of one file descriptor asynchronously, so one thread can keep many of them
+ * in flight. Up to ASYNC_IO_QUEUE_DEPTH requests are in flight at once; Submit blocks while that many are.
+ */
+class AsyncIoEngine {
+ public:
+  /**
+   * Create an engine for a file descriptor: io_uring if the kernel supports it, a thread pool otherwise.
+   * @param fd the file descriptor
+   * @param use_io_uring false to always use the thread pool
+   */
+  static auto Create(int fd, bool use_io_uring = true) -> std::unique_ptr<AsyncIoEngine>;
+
+  explicit AsyncIoEngine(int fd) : fd_(fd) {}
+
+  /** Waits for the requests in flight to finish. */
+  virtual ~AsyncIoEngine() = default;
+
+  /**
+   * Start a request.
+   * @param request the request, handed back to its callback's thread and destroyed once it is done
+   */
+  virtual void Submit(std::unique_ptr<DiskRequest> request) = 0;
+
+  /** @return true if the engine uses io_uring */
+  virtual auto IsIoUring() const -> bool = 0;
+
+ protected:
+  const int fd_;
+};
+
+/**
+ * Submits requests to an io_uring and reaps their completions on a thread of its own. The ring is set up and driven
+ * through the raw io_uring_setup and io_uring_enter system calls.
+ */
+class IoUringEngine : public AsyncIoEngine {
+ public:
+  /**
+   * Set up an io_uring for a file descriptor.
+   * @param fd the file descriptor
+   * @return nullptr if the kernel does not support io_uring (or forbids it)
+   */
+  static auto Create(int fd) -> std::unique_ptr<IoUringEngine>;
+
+  ~IoUringEngine() override;
+
+  void Submit(std::unique_ptr<DiskRequest> request) override;
+
+  auto IsIoUring() const -> bool override { return true; }
+
+ private:
+  explicit IoUringEngine(int fd) : AsyncIoEngine(fd) {}
+
+  /** Map the rings of ring_fd_. */
+  auto MapRings(const io_uring_params &params) -> bool;
+
+  /** Queue one submission queue entry and hand it to the kernel; the caller holds submit_latch_. */
+  void PushSqe(uint8_t opcode, DiskRequest *request);
+
+  /** Body of the reaper thread. */
+  void Reap();
+
+  int ring_fd_{-1};
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_head_;
+  unsigned *sq_tail_;
+  unsigned sq_mask_;
+  unsigned sq_entries_;
+  unsigned *sq_array_;
+  unsigned *cq_head_;
+  unsigned *cq_tail_;
+  unsigned cq_mask_;
+  io_uring_cqe *cqes_;
+
+  /** Serializes submissions: the submission queue has a single producer. Protects in_flight_. */
+  std::mutex submit_latch_;
+  /** Signalled when a request finishes. */
+  std::condition_variable slot_cv_;
+  size_t in_flight_{0};
+  std::thread reaper_;
+};
+
+/**
+ * Runs requests with pread and pwrite on ASYNC_IO_THREADS threads, for kernels without io_uring.
+ */
+class ThreadPoolIoEngine : public AsyncIoEngine {
+ public:
+  explicit ThreadPoolIoEngine(int fd);
+
+  ~ThreadPoolIoEngine() override;
+
+  void Submit(std::unique_ptr<DiskRequest> request) override;
+
+  auto IsIoUring() const -> bool override { return false; }
+
+ private:
+  /** Body of the worker threads. */
+  void Work();
+
+  /** Protects queue_, in_flight_ and stop_. */
+  std::mutex latch_;
+  /** Signalled when a request is queued or the workers should stop. */
+  std::condition_variable queue_cv_;
+  /** Signalled when a request finishes. */
+  std::condition_variable slot_cv_;
+  std::deque<std::unique_ptr<DiskRequest>> queue_;
+  size_t in_flight_{0};
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
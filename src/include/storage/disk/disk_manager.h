@@ -15,29 +15,66 @@
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/async_io.h"
+#include "storage/disk/free_space_map.h"
+#include "storage/disk/page_checksums.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with pread/pwrite on a file descriptor: there is no shared file cursor, so page I/O of
+ * different threads (e.g. the instances of a parallel buffer pool) does not need a latch and runs concurrently. The
+ * size of the database file is cached instead of being looked up for every read.
+ *
+ * With direct I/O the database file is opened with O_DIRECT and bypasses the OS page cache, which would otherwise hold
+ * a second copy of every page in the buffer pool. O_DIRECT needs buffers aligned to DIRECT_IO_ALIGNMENT; pages that are
+ * not go through a per-thread aligned bounce buffer. File systems that do not support O_DIRECT fall back to buffered
+ * I/O.
+ *
+ * ReadPageAsync and WritePageAsync return right away and let one thread keep many page I/Os in flight. They run on an
+ * AsyncIoEngine (io_uring, or a thread pool where that is not available) that is started on first use.
+ *
+ * Which pages are allocated is recorded in a FreeSpaceMap, kept in a side file (the database file name with the
+ * extension .fsm) that is loaded when an existing database file is opened and saved on shut down. The file is removed
+ * once it is loaded, and a database file without a map is taken to be fully allocated: after a crash, pages allocated
+ * since the last shut down leak instead of being handed out twice.
+ *
+ * With checksums every page written gets its CRC-32C recorded (see PageChecksums) and every page read is checked
+ * against it, so that a page the disk corrupted is caught instead of handed to the buffer pool. The checksums are
+ * kept in a side file with the extension .crc. It is synced where the pages are: WritePages syncs it once for its
+ * batch, before writing the pages, and ShutDown syncs it too. Without checksums no page is checksummed, and the side
+ * file is removed since the pages written would no longer match it.
  */
 class DiskManager {
  public:
+  /** The alignment of the buffers, offsets and sizes of direct I/O. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = PAGE_SIZE;
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io true to bypass the OS page cache for the database file
+   * @param checksums true to checksum the pages written and check the pages read
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false, bool checksums = false);
 
-  ~DiskManager() = default;
+  /**
+   * Waits for the asynchronous I/O in flight and closes the database file.
+   */
+  ~DiskManager();
 
   /**
-   * Shut down the disk manager and close all the file resources.
+   * Shut down the disk manager: save the free space map, sync the page checksums, close the log file and fail all
+   * further page I/O. The database file is closed by the destructor, as page I/O already under way may still use it.
    */
   void ShutDown();
 
@@ -49,11 +86,66 @@ class DiskManager {
   void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file. A page that does not match its checksum is still read, and counted in
+   * GetNumChecksumFailures.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @return false if the page could not be read or does not match its checksum
+   */
+  auto ReadPage(page_id_t page_id, char *page_data) -> bool;
+
+  /**
+   * Write several pages to the database file as one batch: they are sorted by page id, each run of adjacent pages is
+   * written with a single pwritev, and the batch is made durable with one fdatasync.
+   * @param page_ids ids of the pages; if one is given twice, the last data given for it wins
+   * @param page_data raw page data, one per page
+   * @return false if a write or the sync failed
+   */
+  auto WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) -> bool;
+
+  /**
+   * Start writing a page to the database file.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay valid and unchanged until the write is done
+   * @return becomes true once the page was written, false if it could not be
+   */
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool>;
+
+  /**
+   * Start reading a page from the database file.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must stay valid until the read is done
+   * @return becomes true once the page was read, false if it could not be or does not match its checksum
+   */
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool>;
+
+  /**
+   * Read several pages from the database file in one go, all of them in flight at once.
+   * @param page_ids ids of the pages
+   * @param[out] page_data one output buffer per page
+   * @param[out] intact if not null, set to whether each page was read and matches its checksum
+   * @return false if any of the pages could not be read or does not match its checksum
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  auto ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data,
+                 std::vector<bool> *intact = nullptr) -> bool;
+
+  /**
+   * Reserve disk space for a range of pages with fallocate, so that a table or index growing into them gets contiguous
+   * blocks. The pages read as zeros until they are written.
+   * @param first_page_id the first page
+   * @param end_page_id one past the last page
+   */
+  void PreallocatePages(page_id_t first_page_id, page_id_t end_page_id);
+
+  /**
+   * Give the disk space of a deleted page back by punching a hole in the file, so that the page reads as zeros when
+   * its id is reused. Where holes are not supported, the page is overwritten with zeros.
+   * @param page_id id of the page
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /** @return the map of the allocated pages */
+  auto GetFreeSpaceMap() -> FreeSpaceMap * { return &free_space_map_; }
 
   /**
    * Flush the entire log buffer into disk.
@@ -80,6 +172,21 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of system calls WritePages wrote its pages with */
+  auto GetNumVectoredWrites() const -> int { return num_vectored_writes_; }
+
+  /** @return the number of pages read that did not match their checksum */
+  auto GetNumChecksumFailures() const -> int { return num_checksum_failures_; }
+
+  /** @return true if the pages are checksummed */
+  auto IsChecksummed() const -> bool { return checksums_; }
+
+  /** @return true if the database file was opened with O_DIRECT */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
+  /** @return true if asynchronous page I/O runs on io_uring */
+  auto IsIoUring() -> bool { return GetAsyncIo()->IsIoUring(); }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -91,18 +198,46 @@ class DiskManager {
 
  private:
   auto GetFileSize(const std::string &file_name) -> int;
+  /**
+   * Open the database file, creating it if it does not exist.
+   * @param flags extra open flags
+   * @return the file descriptor, -1 on error
+   */
+  auto OpenDbFile(int flags) -> int;
+  /** @return the engine of the asynchronous page I/O, started on the first call */
+  auto GetAsyncIo() -> AsyncIoEngine *;
+  /** Record that the database file now extends at least to end. */
+  void GrowFileSize(int64_t end);
+  /**
+   * Check a page that was read against its checksum, if checksums are on.
+   * @return false if the page is corrupt
+   */
+  auto VerifyPage(page_id_t page_id, const char *page_data) -> bool;
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file, only used with positional reads and writes
+  int db_fd_{-1};
   std::string file_name_;
-  int num_flushes_;
-  int num_writes_;
+  bool direct_io_{false};
+  std::atomic<bool> shut_down_{false};
+  // size of the db file, grown by writes past its end
+  std::atomic<int64_t> db_file_size_{0};
+  std::atomic<int> num_flushes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_vectored_writes_{0};
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+  // the allocated pages of the db file and the file they are saved in
+  FreeSpaceMap free_space_map_;
+  std::string fsm_name_;
+  // the checksums of the pages written, if checksums_, and the file they are saved in
+  bool checksums_{false};
+  PageChecksums page_checksums_;
+  std::string crc_name_;
+  std::atomic<int> num_checksum_failures_{0};
+  std::once_flag async_io_started_;
+  std::unique_ptr<AsyncIoEngine> async_io_;
 };
 
 }  // namespace bustub
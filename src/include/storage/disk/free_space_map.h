@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/disk/free_space_map.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap keeps one bit per page of the database file: set if the page is allocated. The buffer pool allocates
+ * and frees pages through it (see ExtentAllocator), so freed pages are reused and the file stops growing under churn.
+ *
+ * The DiskManager keeps the map in a side file next to the database file. It is written to a temporary file first and
+ * renamed over the old one, like the warm cache file. The map is safe to use from several threads.
+ */
+class FreeSpaceMap {
+ public:
+  /** @return true if the page is allocated */
+  auto IsAllocated(page_id_t page_id) const -> bool;
+
+  /**
+   * Mark a page allocated or free.
+   * @param page_id the page
+   * @param allocated true to mark it allocated
+   * @return false if it was marked so already
+   */
+  auto SetAllocated(page_id_t page_id, bool allocated) -> bool;
+
+  /** Mark the pages [0, end) allocated, e.g. those of a database file whose map was lost. */
+  void SetAllAllocated(page_id_t end);
+
+  /** @return one past the highest page that was ever allocated */
+  auto GetEnd() const -> page_id_t;
+
+  /** @return the number of allocated pages */
+  auto GetNumAllocated() const -> size_t;
+
+  /**
+   * Save the map.
+   * @param file_name the file
+   * @return false if the file could not be written
+   */
+  auto Save(const std::string &file_name) const -> bool;
+
+  /**
+   * Replace the map by the one in a file written by Save.
+   * @param file_name the file
+   * @return false if the file does not exist or is not a free space map file; the map is left empty then
+   */
+  auto Load(const std::string &file_name) -> bool;
+
+ private:
+  static constexpr uint32_t FREE_SPACE_MAP_MAGIC = 0x4D535446;  // "FTSM"
+
+  /** Protects bits_. */
+  mutable std::mutex latch_;
+  /** Bit i % 64 of word i / 64 is set if page i is allocated. */
+  std::vector<uint64_t> bits_;
+};
+
+}  // namespace bustub
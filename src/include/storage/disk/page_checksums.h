@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksums.h
+//
+// Identification: src/include/storage/disk/page_checksums.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageChecksums keeps the CRC-32C (see Crc32c) of every page of the database file as it was last written, so that a
+ * page read back can be checked against it. A page that was not written since the checksums were started, or that
+ * was deallocated, has no checksum and is not checked.
+ *
+ * The checksums are kept in a side file next to the database file (see Open) that the entries are mapped from, so
+ * every Set and Clear goes to the file without a system call and the checksums survive a restart. Writing a page and
+ * its checksum is not atomic, so an entry keeps the checksum of the page's previous version too, and a page that
+ * matches either one passes; a page that matches neither, e.g. one torn by a crash, fails. The file is only synced
+ * when a caller asks for it (see Sync), which callers that sync the pages anyway do before writing them. Pages written
+ * without that can, after a power failure, be on disk ahead of their checksum and fail their check. A write that was
+ * lost altogether is not caught.
+ *
+ * The entries are read without any latch: they sit in chunks that are mapped (or, without a file, allocated) on first
+ * use and never move, and each entry is a single atomic word. Writers of the same entry are serialized by one of
+ * NUM_SHARDS latches, picked by page id. The checksum of the data read is computed outside of any latch. The checksums
+ * are safe to use from several threads.
+ */
+class PageChecksums {
+ public:
+  PageChecksums();
+
+  /** Closes the checksum file, if one was opened. */
+  ~PageChecksums();
+
+  /** @return the checksum of a page */
+  static auto Compute(const char *page_data) -> uint32_t;
+
+  /**
+   * Keep the checksums in a file from now on, with the ones it already holds. A file that is not a checksum file is
+   * started over. Must be called before any checksum is set.
+   * @param file_name the file, created if it does not exist
+   * @return false if the file could not be opened or read; the checksums are then only kept in memory
+   */
+  auto Open(const std::string &file_name) -> bool;
+
+  /**
+   * Record the checksum of a page that is about to be written. Its old checksum, if any, is still accepted until the
+   * page is written again.
+   * @param page_id the page
+   * @param checksum its checksum
+   */
+  void Set(page_id_t page_id, uint32_t checksum);
+
+  /** Forget the checksum of a page. */
+  void Clear(page_id_t page_id);
+
+  /**
+   * Check a page that was read.
+   * @param page_id the page
+   * @param page_data its contents
+   * @return false if the page has a checksum and the contents match neither its current nor its previous one
+   */
+  auto Verify(page_id_t page_id, const char *page_data) const -> bool;
+
+  /**
+   * Make the checksums set so far durable, e.g. for a caller that is about to write and sync the pages they belong to.
+   * Callers that arrive while a sync is running share the next one, and a sync that started after their checksums
+   * were set covers them without another.
+   * @return false if the file could not be synced
+   */
+  auto Sync() -> bool;
+
+ private:
+  static constexpr uint32_t PAGE_CHECKSUMS_MAGIC = 0x32504342;  // "BCP2"
+  /** Size of the file header, the magic number padded so that the chunks after it are aligned for mmap. */
+  static constexpr size_t HEADER_SIZE = size_t{1} << 16;
+  static constexpr size_t NUM_SHARDS = 16;
+  /** Page ids are 31 bits, so NUM_CHUNKS chunks of ENTRIES_PER_CHUNK entries hold the entries of all of them. */
+  static constexpr size_t ENTRIES_PER_CHUNK = size_t{1} << 16;
+  static constexpr size_t NUM_CHUNKS = (size_t{1} << 31) / ENTRIES_PER_CHUNK;
+  static constexpr size_t CHUNK_SIZE = ENTRIES_PER_CHUNK * sizeof(uint64_t);
+
+  /**
+   * @return the entry of a page: its current checksum in the low 32 bits and its previous one in the high 32 bits, 0
+   * for no checksum
+   */
+  auto GetEntry(page_id_t page_id) const -> uint64_t;
+
+  /** Store the entry of a page, which with a file is in the file. Requires the latch of the page's shard. */
+  void PutEntry(page_id_t page_id, uint64_t entry);
+
+  /**
+   * Add a chunk: mapped from the file, which is grown to cover it if need be, or without a file allocated. Requires
+   * chunk_latch_.
+   * @return the chunk, null if the file could not be grown or mapped
+   */
+  auto MapChunk(size_t chunk_index) -> std::atomic<uint64_t> *;
+
+  /** @return the latch that serializes the writers of a page's entry */
+  auto GetShardLatch(page_id_t page_id) -> std::mutex & { return shard_latches_[page_id % NUM_SHARDS]; }
+
+  /** The entries of the pages with page_id / ENTRIES_PER_CHUNK == i in chunks_[i], null until one is set. */
+  std::unique_ptr<std::atomic<std::atomic<uint64_t> *>[]> chunks_;
+  std::array<std::mutex, NUM_SHARDS> shard_latches_;
+  /** Serializes adding chunks. */
+  std::mutex chunk_latch_;
+  /** The number of chunks the file covers. Protected by chunk_latch_. */
+  size_t num_file_chunks_{0};
+  /** The number of entries stored so far. */
+  std::atomic<uint64_t> num_puts_{0};
+  /** Serializes Sync calls. */
+  std::mutex sync_latch_;
+  /** The number of entries written to the file before the last successful sync started. Protected by sync_latch_. */
+  uint64_t num_synced_puts_{0};
+  /** The checksum file, -1 if there is none. */
+  int fd_{-1};
+};
+
+}  // namespace bustub
@@ -15,6 +15,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "container/hash/extendible_hash_table.h"
@@ -37,6 +38,8 @@ class ExtendibleHashTableIndex : public Index {
 
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
+  void BulkLoad(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) override;
+
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
  protected:
@@ -167,6 +167,18 @@ class Index {
    */
   virtual void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) = 0;
 
+  /**
+   * Insert many entries into the index at once, as when building it for an existing table. Indexes that can build
+   * themselves in one pass override this; by default the entries are inserted one by one.
+   * @param entries The index keys and the RIDs associated with them
+   * @param transaction The transaction context
+   */
+  virtual void BulkLoad(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) {
+    for (const auto &[key, rid] : entries) {
+      InsertEntry(key, rid, transaction);
+    }
+  }
+
   /**
    * Search the index for the provided key.
    * @param key The index key
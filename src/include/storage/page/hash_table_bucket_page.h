@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -33,6 +34,10 @@ namespace bustub {
  *  The above format omits the space required for the occupied_ and
  *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
  *
+ *  Every slot also has a one-byte fingerprint of its key in fingerprints_. Lookups compare the fingerprints of a
+ *  group of slots against the fingerprint of the key at once (16 with SSE2, 32 with AVX2) and only call the
+ *  comparator on the readable slots that match.
+ *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBucketPage {
@@ -137,11 +142,19 @@ class HashTableBucketPage {
    */
   void PrintBucket();
 
+  /**
+   * @param key a key
+   * @return the fingerprint of the key, which equal keys share
+   */
+  static auto Fingerprint(const KeyType &key) -> uint8_t;
+
  private:
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  // Fingerprint of the key of each readable slot.
+  uint8_t fingerprints_[BUCKET_ARRAY_SIZE];
   // Flexible array member for page data.
   MappingType array_[0];
 };
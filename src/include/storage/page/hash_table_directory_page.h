@@ -27,6 +27,11 @@ namespace bustub {
  *
  * Directory Page for extendible hash table.
  *
+ * A directory page holds DIRECTORY_ARRAY_SIZE slots of a directory that may span several pages, as listed by its
+ * HashTableDirectoryRootPage. Slots are addressed by their index in the whole directory, of which the page only uses
+ * the low bits, so split images and local depth masks come out the same as for a directory on one page. The global
+ * depth of a page is the directory's, capped at log2(DIRECTORY_ARRAY_SIZE).
+ *
  * Directory format (size in byte):
  * --------------------------------------------------------------------------------------------
  * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) |
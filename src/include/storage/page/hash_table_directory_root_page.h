@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_root_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_root_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <string>
+
+#include "storage/index/generic_key.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ *
+ * Root Page of the directory of an extendible hash table.
+ *
+ * The directory is cut into directory pages of DIRECTORY_ARRAY_SIZE slots each, which are listed in slot order by
+ * segment pages (see HashTableDirectorySegmentPage) of DIRECTORY_SEGMENT_ARRAY_SIZE directory pages each. The root page
+ * holds the global depth and the segment pages: the slot of directory index i is on directory page
+ * d = i / DIRECTORY_ARRAY_SIZE, which segment page d / DIRECTORY_SEGMENT_ARRAY_SIZE lists. Up to a global depth of
+ * log2(DIRECTORY_ARRAY_SIZE) there is a single directory page, and up to log2(DIRECTORY_ARRAY_SIZE *
+ * DIRECTORY_SEGMENT_ARRAY_SIZE) a single segment page.
+ *
+ * Root format (size in byte):
+ * --------------------------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | GlobalDepth(4) | SegmentPageIds(2048) | Free(2036)
+ * --------------------------------------------------------------------------------------------
+ */
+class HashTableDirectoryRootPage {
+ public:
+  /**
+   * @return the page ID of this page
+   */
+  auto GetPageId() const -> page_id_t;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id to which to set the page_id_ field
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  auto GetLSN() const -> lsn_t;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number to which to set the lsn field
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @return the global depth of the hash table directory
+   */
+  auto GetGlobalDepth() -> uint32_t;
+
+  /**
+   * @return mask of global_depth 1's and the rest 0's (with 1's from LSB upwards)
+   */
+  auto GetGlobalDepthMask() -> uint32_t;
+
+  /**
+   * Increment the global depth of the directory. The directory pages for the new upper half, and the segment pages
+   * listing them, must have been set.
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * Decrement the global depth of the directory
+   */
+  void DecrGlobalDepth();
+
+  /**
+   * @return true if the directory can be doubled once more
+   */
+  auto CanGrow() -> bool;
+
+  /**
+   * @return the current directory size, in slots
+   */
+  auto Size() -> uint32_t;
+
+  /**
+   * @return the number of directory pages the directory currently spans
+   */
+  auto NumDirectoryPages() -> uint32_t;
+
+  /**
+   * @return the number of segment pages the directory currently spans
+   */
+  auto NumSegments() -> uint32_t;
+
+  /**
+   * Gets the directory page holding the slot of a directory index
+   *
+   * @param bucket_idx the directory index
+   * @return the index of the directory page in the directory
+   */
+  auto GetDirectoryIndex(uint32_t bucket_idx) -> uint32_t;
+
+  /**
+   * Gets the segment page listing a directory page
+   *
+   * @param directory_idx the index of the directory page
+   * @return the index of the segment page in the root page
+   */
+  auto GetSegmentIndex(uint32_t directory_idx) -> uint32_t;
+
+  /**
+   * Lookup a segment page using its index in the root page
+   *
+   * @param segment_idx the index of the segment page
+   * @return page_id of the segment page
+   */
+  auto GetSegmentPageId(uint32_t segment_idx) -> page_id_t;
+
+  /**
+   * Updates the root page using a segment page index and page_id
+   *
+   * @param segment_idx index at which to insert page_id
+   * @param segment_page_id page_id to insert
+   */
+  void SetSegmentPageId(uint32_t segment_idx, page_id_t segment_page_id);
+
+ private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  uint32_t global_depth_{0};
+  page_id_t segment_page_ids_[DIRECTORY_ROOT_ARRAY_SIZE];
+};
+
+}  // namespace bustub
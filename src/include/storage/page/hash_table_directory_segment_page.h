@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_segment_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_segment_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "common/config.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ *
+ * Segment Page of the directory of an extendible hash table.
+ *
+ * A segment page lists DIRECTORY_SEGMENT_ARRAY_SIZE consecutive directory pages of a directory, as listed by its
+ * HashTableDirectoryRootPage. Directory pages are addressed by their index in the whole directory, of which the page
+ * only uses the low bits.
+ *
+ * Segment format (size in byte):
+ * --------------------------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | DirectoryPageIds(2048) | Free(2040)
+ * --------------------------------------------------------------------------------------------
+ */
+class HashTableDirectorySegmentPage {
+ public:
+  /**
+   * @return the page ID of this page
+   */
+  auto GetPageId() const -> page_id_t;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id to which to set the page_id_ field
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  auto GetLSN() const -> lsn_t;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number to which to set the lsn field
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * Lookup a directory page using its index in the directory
+   *
+   * @param directory_idx the index of the directory page
+   * @return page_id of the directory page
+   */
+  auto GetDirectoryPageId(uint32_t directory_idx) -> page_id_t;
+
+  /**
+   * Updates the segment page using a directory page index and page_id
+   *
+   * @param directory_idx index at which to insert page_id
+   * @param directory_page_id page_id to insert
+   */
+  void SetDirectoryPageId(uint32_t directory_idx, page_id_t directory_page_id);
+
+ private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  page_id_t directory_page_ids_[DIRECTORY_SEGMENT_ARRAY_SIZE];
+};
+
+}  // namespace bustub
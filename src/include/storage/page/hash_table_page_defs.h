@@ -34,11 +34,21 @@
 #define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
 #define DIRECTORY_ARRAY_SIZE 512
 
+/**
+ * DIRECTORY_SEGMENT_ARRAY_SIZE is the number of directory pages a directory segment page can point to, and
+ * DIRECTORY_ROOT_ARRAY_SIZE the number of segment pages a directory root page can point to. DIRECTORY_MAX_DEPTH is
+ * the global depth of a directory that uses all of them: DIRECTORY_ROOT_ARRAY_SIZE * DIRECTORY_SEGMENT_ARRAY_SIZE *
+ * DIRECTORY_ARRAY_SIZE slots.
+ */
+#define DIRECTORY_SEGMENT_ARRAY_SIZE 512
+#define DIRECTORY_ROOT_ARRAY_SIZE 512
+#define DIRECTORY_MAX_DEPTH 27
+
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hashing bucket page.
  * It is an approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType).
- * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * (PAGE_SIZE - 4) / (4 * sizeof
- * (MappingType) + 1) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * For each key/value pair, we need two additional bits for occupied_ and readable_ and a byte for its fingerprint.
+ * 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 5) = PAGE_SIZE/(sizeof (MappingType) + 1.25) because 1.25 bytes is the
+ * space required to maintain the occupied and readable flags and the fingerprint of a key value pair.
  */
-#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 5))
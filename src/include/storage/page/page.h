@@ -12,26 +12,53 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
 
 namespace bustub {
 
+class Page;
+
+/**
+ * A SwizzleOwner keeps swizzled references: direct pointers to the frames of pages it refers to by page id, which let
+ * it pin a resident page without a page table lookup (see BufferPoolManager::FetchSwizzledPage).
+ */
+class SwizzleOwner {
+ public:
+  virtual ~SwizzleOwner() = default;
+
+  /**
+   * Called by the buffer pool before it gives the frame of a page this owner swizzled to another page. The owner has
+   * to drop every reference to the frame. Runs with the buffer pool latched, so it must not call back into the pool.
+   * @param page the frame
+   */
+  virtual void Unswizzle(Page *page) = 0;
+};
+
 /**
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
+ *
+ * The buffer pool keeps its pages in a separate data area; a Page object is only the frame's descriptor, aligned to a
+ * cache line with the fields a hit touches up front. A Page created on its own owns its data.
  */
-class Page {
+class alignas(64) Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Allocates the page data and zeros it out. */
+  Page() : owned_data_(new char[PAGE_SIZE]), data_(owned_data_.get()) { ResetMemory(); }
+
+  /** Constructor for a buffer pool frame whose data lives elsewhere. The data is left as it is. */
+  explicit Page(char *data) : data_(data) {}
 
   /** Default destructor. */
   ~Page() = default;
@@ -43,16 +70,43 @@ class Page {
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
   /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  inline auto GetPinCount() -> int {
+    // negative while the buffer pool owns the frame (free, or being reassigned): nobody has it pinned then
+    return std::max(pin_count_.load(), 0);
+  }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
   /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
+
+  /**
+   * Start an optimistic read of a page that is neither pinned nor latched. The data may change (or the frame may get
+   * another page) at any point; whatever was read has to be thrown away unless ValidateVersion succeeds afterwards.
+   * Only pages whose writers hold the write latch can be read this way.
+   * @return the current version, odd if a writer is active (the read cannot succeed)
+   */
+  inline auto GetVersion() -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * Finish an optimistic read.
+   * @param version the result of GetVersion before the read
+   * @return true if nobody wrote the page (or reassigned its frame) since the version was taken
+   */
+  inline auto ValidateVersion(uint64_t version) -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version % 2 == 0 && version_.load(std::memory_order_relaxed) == version;
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -78,16 +132,27 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
+  /** The data of a page created on its own. */
+  std::unique_ptr<char[]> owned_data_;
   /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  char *data_;
+  /** The ID of this page. Atomic because the buffer pool validates lock-free pins against it. */
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /**
+   * The pin count of this page. Hits pin and unpin it with atomic read-modify-writes; the buffer pool sets it to -1
+   * (only from 0, with a compare-and-swap) while the frame is free or being reassigned, which makes pins fail.
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
+  /** True while the buffer pool is reading this page in (or writing back its previous contents) without its latch. */
+  std::atomic<bool> io_in_progress_{false};
+  /** Bumped when a writer latches and unlatches the page and when the buffer pool reassigns the frame; odd between. */
+  std::atomic<uint64_t> version_{0};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** The owner of the swizzled references to this frame, if there are any. */
+  std::atomic<SwizzleOwner *> swizzle_owner_{nullptr};
 };
 
 }  // namespace bustub
@@ -55,9 +55,11 @@ class TableHeap {
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy how the caller is filling the table, e.g. BULK_WRITE for a load of many tuples
    * @return true iff the insert is successful
    */
-  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, AccessStrategy strategy = AccessStrategy::NORMAL)
+      -> bool;
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -95,9 +97,11 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param strategy how the caller is walking the table, e.g. SEQUENTIAL for a scan
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool;
+  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, AccessStrategy strategy = AccessStrategy::NORMAL)
+      -> bool;
 
   /** @return the begin iterator of this table */
   auto Begin(Transaction *txn) -> TableIterator;
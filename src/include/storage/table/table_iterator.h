@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "buffer/scan_handle.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -32,7 +33,7 @@ class TableIterator {
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_), scan_(other.scan_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -54,6 +55,7 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    scan_ = other.scan_;
     return *this;
   }
 
@@ -61,6 +63,8 @@ class TableIterator {
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** The read-ahead state of the scan, its own so that concurrent scans of the buffer pool are all read ahead. */
+  ScanHandle scan_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,254 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io.cpp
+//
+// Identification: src/storage/disk/async_io.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_io.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+auto IoUringSetup(unsigned entries, io_uring_params *params) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+/** The user data of the entry that tells the reaper to stop; requests are never at address 0. */
+constexpr uint64_t STOP_USER_DATA = 0;
+}  // namespace
+
+auto AsyncIoEngine::Create(int fd, bool use_io_uring) -> std::unique_ptr<AsyncIoEngine> {
+  if (use_io_uring) {
+    auto engine = IoUringEngine::Create(fd);
+    if (engine != nullptr) {
+      return engine;
+    }
+    LOG_DEBUG("io_uring is not available, falling back to a thread pool");
+  }
+  return std::make_unique<ThreadPoolIoEngine>(fd);
+}
+
+/*
+ * IoUringEngine
+ */
+
+auto IoUringEngine::Create(int fd) -> std::unique_ptr<IoUringEngine> {
+  std::unique_ptr<IoUringEngine> engine(new IoUringEngine(fd));
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  engine->ring_fd_ = IoUringSetup(ASYNC_IO_QUEUE_DEPTH, &params);
+  if (engine->ring_fd_ < 0 || !engine->MapRings(params)) {
+    return nullptr;
+  }
+  engine->reaper_ = std::thread(&IoUringEngine::Reap, engine.get());
+  return engine;
+}
+
+auto IoUringEngine::MapRings(const io_uring_params &params) -> bool {
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    // both rings live in one mapping
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    return false;
+  }
+  if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      return false;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return false;
+  }
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  return true;
+}
+
+IoUringEngine::~IoUringEngine() {
+  if (reaper_.joinable()) {
+    std::unique_lock<std::mutex> lock(submit_latch_);
+    slot_cv_.wait(lock, [this] { return in_flight_ == 0; });
+    PushSqe(IORING_OP_NOP, nullptr);
+    lock.unlock();
+    reaper_.join();
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+void IoUringEngine::Submit(std::unique_ptr<DiskRequest> request) {
+  std::unique_lock<std::mutex> lock(submit_latch_);
+  // the completion queue is twice the size of the submission queue, so it can never overflow
+  slot_cv_.wait(lock, [this] { return in_flight_ < sq_entries_; });
+  in_flight_++;
+  request->iov_.iov_base = request->data_;
+  request->iov_.iov_len = request->size_;
+  uint8_t opcode = request->is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+  PushSqe(opcode, request.release());
+}
+
+void IoUringEngine::PushSqe(uint8_t opcode, DiskRequest *request) {
+  // only this thread moves the tail, the kernel moves the head
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  if (request != nullptr) {
+    sqe->fd = fd_;
+    sqe->off = static_cast<uint64_t>(request->offset_);
+    sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+    sqe->len = 1;
+  }
+  sqe->user_data = request == nullptr ? STOP_USER_DATA : reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  // the kernel must see the entry before the new tail
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+  while (IoUringEnter(ring_fd_, 1, 0, 0) < 0) {
+    if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      throw Exception("io_uring_enter failed");
+    }
+  }
+}
+
+void IoUringEngine::Reap() {
+  while (true) {
+    // only this thread moves the head, the kernel moves the tail
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+      continue;
+    }
+    io_uring_cqe *cqe = &cqes_[head & cq_mask_];
+    uint64_t user_data = cqe->user_data;
+    auto result = static_cast<ssize_t>(cqe->res);
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    if (user_data == STOP_USER_DATA) {
+      return;
+    }
+
+    std::unique_ptr<DiskRequest> request(reinterpret_cast<DiskRequest *>(user_data));
+    request->callback_(result);
+    {
+      std::lock_guard<std::mutex> lg(submit_latch_);
+      in_flight_--;
+    }
+    slot_cv_.notify_all();
+  }
+}
+
+/*
+ * ThreadPoolIoEngine
+ */
+
+ThreadPoolIoEngine::ThreadPoolIoEngine(int fd) : AsyncIoEngine(fd) {
+  for (int i = 0; i < ASYNC_IO_THREADS; i++) {
+    workers_.emplace_back(&ThreadPoolIoEngine::Work, this);
+  }
+}
+
+ThreadPoolIoEngine::~ThreadPoolIoEngine() {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    slot_cv_.wait(lock, [this] { return in_flight_ == 0; });
+    stop_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPoolIoEngine::Submit(std::unique_ptr<DiskRequest> request) {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    slot_cv_.wait(lock, [this] { return in_flight_ < static_cast<size_t>(ASYNC_IO_QUEUE_DEPTH); });
+    in_flight_++;
+    queue_.push_back(std::move(request));
+  }
+  queue_cv_.notify_one();
+}
+
+void ThreadPoolIoEngine::Work() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (stop_) {
+      return;
+    }
+    auto request = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+
+    ssize_t result;
+    do {
+      result = request->is_write_ ? pwrite(fd_, request->data_, request->size_, request->offset_)
+                                  : pread(fd_, request->data_, request->size_, request->offset_);
+    } while (result < 0 && errno == EINTR);
+    request->callback_(result < 0 ? -errno : result);
+    request.reset();
+
+    lock.lock();
+    in_flight_--;
+    slot_cv_.notify_all();
+  }
+}
+
+}  // namespace bustub
@@ -10,11 +10,21 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>  // NOLINT
+#include <numeric>
 #include <string>
 #include <thread>  // NOLINT
 
@@ -26,12 +36,86 @@ namespace bustub {
 
 static char *buffer_used;
 
+namespace {
+/**
+ * pread/pwrite size bytes at offset, retrying short and interrupted transfers.
+ * @return the number of bytes transferred (less than size only at the end of the file), -1 on error
+ */
+template <typename Buffer, typename Io>
+auto TransferFully(int fd, Buffer buf, size_t size, off_t offset, Io io) -> ssize_t {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t n = io(fd, buf + done, size - done, offset + static_cast<off_t>(done));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      return -1;
+    }
+    if (n == 0) {
+      break;
+    }
+    done += static_cast<size_t>(n);
+  }
+  return static_cast<ssize_t>(done);
+}
+
+/**
+ * pwritev all of iov at offset, retrying short and interrupted writes. iov is used up in the process.
+ * @return false on error
+ */
+auto PwritevFully(int fd, std::vector<struct iovec> *iov, off_t offset) -> bool {
+  size_t first = 0;
+  while (first < iov->size()) {
+    ssize_t n = pwritev(fd, iov->data() + first, static_cast<int>(iov->size() - first), offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    offset += n;
+    // skip what was written, which can end in the middle of a buffer
+    auto written = static_cast<size_t>(n);
+    while (first < iov->size() && written >= (*iov)[first].iov_len) {
+      written -= (*iov)[first++].iov_len;
+    }
+    if (written > 0) {
+      (*iov)[first].iov_base = static_cast<char *>((*iov)[first].iov_base) + written;
+      (*iov)[first].iov_len -= written;
+    }
+  }
+  return true;
+}
+
+/** @return a page-sized buffer aligned for direct I/O */
+auto AllocateBounceBuffer() -> std::shared_ptr<char> {
+  return {static_cast<char *>(std::aligned_alloc(DiskManager::DIRECT_IO_ALIGNMENT, PAGE_SIZE)), std::free};
+}
+
+/** @return a page-sized buffer aligned for direct I/O, one per thread */
+auto GetBounceBuffer() -> char * {
+  thread_local std::shared_ptr<char> buffer = AllocateBounceBuffer();
+  return buffer.get();
+}
+
+/** @return true if page_data can be handed to direct I/O as it is */
+auto IsAligned(const char *page_data) -> bool {
+  return reinterpret_cast<uintptr_t>(page_data) % DiskManager::DIRECT_IO_ALIGNMENT == 0;
+}
+}  // namespace
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io, bool checksums)
+    : file_name_(db_file),
+      num_flushes_(0),
+      num_writes_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr),
+      checksums_(checksums) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -53,30 +137,69 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  if (direct_io) {
+    db_fd_ = OpenDbFile(O_DIRECT);
+    direct_io_ = db_fd_ != -1;
+    if (!direct_io_) {
+      LOG_DEBUG("direct I/O is not supported for %s, falling back to buffered I/O", db_file.c_str());
     }
   }
+  if (db_fd_ == -1) {
+    db_fd_ = OpenDbFile(0);
+  }
+  if (db_fd_ == -1) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  db_file_size_ = fstat(db_fd_, &stat_buf) == 0 ? stat_buf.st_size : 0;
+
+  // a new database file starts out empty, whatever map a previous one with the same name left behind
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
+  if (db_file_size_ > 0 && !free_space_map_.Load(fsm_name_)) {
+    LOG_DEBUG("no free space map for %s, taking all of it to be allocated", db_file.c_str());
+    free_space_map_.SetAllAllocated(static_cast<page_id_t>((db_file_size_ + PAGE_SIZE - 1) / PAGE_SIZE));
+  }
+  // the map is only saved on shut down: after a crash it would miss the pages allocated since, which must not be
+  // handed out again, so a restart without it takes the whole file to be allocated
+  std::remove(fsm_name_.c_str());
+  // a new database file has no checksums yet, and pages written without checksums would leave the old ones stale
+  crc_name_ = file_name_.substr(0, n) + ".crc";
+  if (db_file_size_ == 0 || !checksums_) {
+    std::remove(crc_name_.c_str());
+  }
+  if (checksums_ && !page_checksums_.Open(crc_name_)) {
+    throw Exception("can't open page checksum file");
+  }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  if (!shut_down_ && !fsm_name_.empty()) {
+    free_space_map_.Save(fsm_name_);
+  }
+  // waits for the asynchronous I/O in flight
+  async_io_.reset();
+  close(db_fd_);
+}
+
+auto DiskManager::OpenDbFile(int flags) -> int {
+  int fd;
+  do {
+    fd = open(file_name_.c_str(), O_RDWR | O_CREAT | flags, 0644);  // NOLINT
+  } while (fd == -1 && errno == EINTR);
+  return fd;
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  // the db file stays open until the destructor: threads of a buffer pool may still be in the middle of page I/O
+  if (!shut_down_.exchange(true) && !fsm_name_.empty()) {
+    free_space_map_.Save(fsm_name_);
+  }
+  if (checksums_ && !page_checksums_.Sync()) {
+    LOG_DEBUG("I/O error while syncing the checksums");
   }
   log_io_.close();
 }
@@ -85,47 +208,290 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
+  if (shut_down_) {
+    LOG_DEBUG("I/O error writing after shut down");
+    return;
+  }
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
+  if (direct_io_ && !IsAligned(page_data)) {
+    char *bounce_buffer = GetBounceBuffer();
+    memcpy(bounce_buffer, page_data, PAGE_SIZE);
+    page_data = bounce_buffer;
+  }
+  // the checksum goes first; neither is synced, like the page on its own (see PageChecksums)
+  if (checksums_) {
+    page_checksums_.Set(page_id, PageChecksums::Compute(page_data));
+  }
+  // no flush needed: nothing is buffered in user space
+  if (TransferFully(db_fd_, page_data, PAGE_SIZE, offset, pwrite) != PAGE_SIZE) {
     LOG_DEBUG("I/O error while writing");
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  GrowFileSize(offset + PAGE_SIZE);
+}
+
+auto DiskManager::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data)
+    -> bool {
+  if (shut_down_) {
+    LOG_DEBUG("I/O error writing after shut down");
+    return false;
+  }
+  // stable, so that the last of several writes of a page is written last
+  std::vector<size_t> order(page_ids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&page_ids](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+
+  bool ok = true;
+  if (checksums_) {
+    // only the last of several writes of a page reaches disk, the others must not push its old checksum out
+    for (size_t i = 0; i < order.size(); ++i) {
+      if (i + 1 == order.size() || page_ids[order[i + 1]] != page_ids[order[i]]) {
+        page_checksums_.Set(page_ids[order[i]], PageChecksums::Compute(page_data[order[i]]));
+      }
+    }
+    // the batch is synced, so its checksums have to be durable before any of its pages are
+    if (!page_checksums_.Sync()) {
+      LOG_DEBUG("I/O error while syncing the checksums");
+      ok = false;
+    }
+  }
+  std::vector<struct iovec> iov;
+  std::vector<std::shared_ptr<char>> bounce_buffers;
+  for (size_t begin = 0, end; begin < order.size(); begin = end) {
+    // the run of adjacent pages that starts at begin
+    page_id_t first_page_id = page_ids[order[begin]];
+    iov.clear();
+    for (end = begin; end < order.size(); ++end) {
+      page_id_t page_id = page_ids[order[end]];
+      bool duplicate = end > begin && page_id == page_ids[order[end - 1]];
+      if (!duplicate && (page_id != first_page_id + static_cast<page_id_t>(iov.size()) ||
+                         iov.size() == static_cast<size_t>(IOV_MAX))) {
+        break;
+      }
+      const char *data = page_data[order[end]];
+      if (direct_io_ && !IsAligned(data)) {
+        bounce_buffers.push_back(AllocateBounceBuffer());
+        memcpy(bounce_buffers.back().get(), data, PAGE_SIZE);
+        data = bounce_buffers.back().get();
+      }
+      struct iovec page_iov = {const_cast<char *>(data), PAGE_SIZE};
+      if (duplicate) {
+        iov.back() = page_iov;
+      } else {
+        iov.push_back(page_iov);
+      }
+    }
+    off_t offset = static_cast<off_t>(first_page_id) * PAGE_SIZE;
+    off_t run_end = offset + static_cast<off_t>(iov.size()) * PAGE_SIZE;
+    num_writes_ += static_cast<int>(iov.size());
+    num_vectored_writes_ += 1;
+    if (!PwritevFully(db_fd_, &iov, offset)) {
+      LOG_DEBUG("I/O error while writing");
+      ok = false;
+      continue;
+    }
+    GrowFileSize(run_end);
+  }
+  if (!order.empty() && fdatasync(db_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing");
+    ok = false;
+  }
+  return ok;
+}
+
+void DiskManager::PreallocatePages(page_id_t first_page_id, page_id_t end_page_id) {
+  if (shut_down_) {
+    return;
+  }
+  off_t offset = static_cast<off_t>(first_page_id) * PAGE_SIZE;
+  off_t length = static_cast<off_t>(end_page_id - first_page_id) * PAGE_SIZE;
+  if (fallocate(db_fd_, 0, offset, length) != 0) {
+    // not supported by the file system: the file grows as pages are written instead
+    return;
+  }
+  GrowFileSize(offset + length);
+}
+
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  if (shut_down_) {
+    return;
+  }
+  if (checksums_) {
+    page_checksums_.Clear(page_id);
+  }
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  if (offset >= db_file_size_ ||
+      fallocate(db_fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, PAGE_SIZE) == 0) {
+    return;
+  }
+  char *zeros = GetBounceBuffer();
+  memset(zeros, 0, PAGE_SIZE);
+  if (TransferFully(db_fd_, static_cast<const char *>(zeros), PAGE_SIZE, offset, pwrite) != PAGE_SIZE) {
+    LOG_DEBUG("I/O error while deallocating");
+  }
+}
+
+auto DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<bool> {
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  if (shut_down_) {
+    LOG_DEBUG("I/O error writing after shut down");
+    std::promise<bool> promise;
+    promise.set_value(false);
+    return promise.get_future();
+  }
+  num_writes_ += 1;
+  std::shared_ptr<char> bounce_buffer;
+  if (direct_io_ && !IsAligned(page_data)) {
+    bounce_buffer = AllocateBounceBuffer();
+    memcpy(bounce_buffer.get(), page_data, PAGE_SIZE);
+    page_data = bounce_buffer.get();
+  }
+  // checksum here rather than on the thread that completes the write
+  if (checksums_) {
+    page_checksums_.Set(page_id, PageChecksums::Compute(page_data));
+  }
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  auto request = std::make_unique<DiskRequest>();
+  request->is_write_ = true;
+  request->data_ = const_cast<char *>(page_data);
+  request->size_ = PAGE_SIZE;
+  request->offset_ = offset;
+  request->callback_ = [this, page_data, offset, promise, bounce_buffer](ssize_t written) {
+    if (written >= 0 && written < PAGE_SIZE) {
+      // finish a short write right here
+      ssize_t rest = TransferFully(db_fd_, page_data + written, PAGE_SIZE - written, offset + written, pwrite);
+      written = rest < 0 ? rest : written + rest;
+    }
+    if (written != PAGE_SIZE) {
+      LOG_DEBUG("I/O error while writing");
+      promise->set_value(false);
+      return;
+    }
+    GrowFileSize(offset + PAGE_SIZE);
+    promise->set_value(true);
+  };
+  GetAsyncIo()->Submit(std::move(request));
+  return future;
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
+auto DiskManager::ReadPage(page_id_t page_id, char *page_data) -> bool {
+  if (shut_down_) {
+    LOG_DEBUG("I/O error reading after shut down");
+    return false;
+  }
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset > db_file_size_) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+    return false;
+  }
+  char *buffer = direct_io_ && !IsAligned(page_data) ? GetBounceBuffer() : page_data;
+  ssize_t read_count = TransferFully(db_fd_, buffer, PAGE_SIZE, offset, pread);
+  if (read_count < 0) {
+    LOG_DEBUG("I/O error while reading");
+    return false;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(buffer + read_count, 0, PAGE_SIZE - read_count);
+  }
+  bool intact = VerifyPage(page_id, buffer);
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, PAGE_SIZE);
+  }
+  return intact;
+}
+
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<bool> {
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  // check if read beyond file length
+  if (shut_down_ || offset > db_file_size_) {
+    LOG_DEBUG("I/O error reading past end of file or after shut down");
+    promise->set_value(false);
+    return future;
+  }
+  std::shared_ptr<char> bounce_buffer;
+  if (direct_io_ && !IsAligned(page_data)) {
+    bounce_buffer = AllocateBounceBuffer();
+  }
+  char *buffer = bounce_buffer != nullptr ? bounce_buffer.get() : page_data;
+  auto request = std::make_unique<DiskRequest>();
+  request->is_write_ = false;
+  request->data_ = buffer;
+  request->size_ = PAGE_SIZE;
+  request->offset_ = offset;
+  request->callback_ = [this, page_id, buffer, page_data, offset, promise, bounce_buffer](ssize_t read_count) {
+    if (read_count > 0 && read_count < PAGE_SIZE) {
+      // a short read that did not hit the end of the file yet
+      ssize_t rest = TransferFully(db_fd_, buffer + read_count, PAGE_SIZE - read_count, offset + read_count, pread);
+      read_count = rest < 0 ? rest : read_count + rest;
+    }
+    if (read_count < 0) {
       LOG_DEBUG("I/O error while reading");
+      promise->set_value(false);
       return;
     }
     // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
     if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+      memset(buffer + read_count, 0, PAGE_SIZE - read_count);
+    }
+    bool intact = VerifyPage(page_id, buffer);
+    if (buffer != page_data) {
+      memcpy(page_data, buffer, PAGE_SIZE);
     }
+    promise->set_value(intact);
+  };
+  GetAsyncIo()->Submit(std::move(request));
+  return future;
+}
+
+auto DiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data,
+                            std::vector<bool> *intact) -> bool {
+  std::vector<std::future<bool>> reads;
+  reads.reserve(page_ids.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    reads.push_back(ReadPageAsync(page_ids[i], page_data[i]));
+  }
+  if (intact != nullptr) {
+    intact->assign(page_ids.size(), true);
+  }
+  bool ok = true;
+  for (size_t i = 0; i < reads.size(); ++i) {
+    if (!reads[i].get()) {
+      ok = false;
+      if (intact != nullptr) {
+        (*intact)[i] = false;
+      }
+    }
+  }
+  return ok;
+}
+
+auto DiskManager::GetAsyncIo() -> AsyncIoEngine * {
+  std::call_once(async_io_started_, [this] { async_io_ = AsyncIoEngine::Create(db_fd_); });
+  return async_io_.get();
+}
+
+auto DiskManager::VerifyPage(page_id_t page_id, const char *page_data) -> bool {
+  if (!checksums_ || page_checksums_.Verify(page_id, page_data)) {
+    return true;
+  }
+  num_checksum_failures_ += 1;
+  LOG_WARN("checksum mismatch in page %d of %s", page_id, file_name_.c_str());
+  return false;
+}
+
+void DiskManager::GrowFileSize(int64_t end) {
+  int64_t file_size = db_file_size_;
+  while (file_size < end && !db_file_size_.compare_exchange_weak(file_size, end)) {
   }
 }
 
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/disk/free_space_map.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_space_map.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+auto FreeSpaceMap::IsAllocated(page_id_t page_id) const -> bool {
+  std::lock_guard<std::mutex> lg(latch_);
+  auto word = static_cast<size_t>(page_id) / 64;
+  return word < bits_.size() && (bits_[word] & (uint64_t{1} << (page_id % 64))) != 0;
+}
+
+auto FreeSpaceMap::SetAllocated(page_id_t page_id, bool allocated) -> bool {
+  std::lock_guard<std::mutex> lg(latch_);
+  auto word = static_cast<size_t>(page_id) / 64;
+  uint64_t bit = uint64_t{1} << (page_id % 64);
+  if (word >= bits_.size()) {
+    if (!allocated) {
+      return false;
+    }
+    bits_.resize(word + 1, 0);
+  }
+  if (((bits_[word] & bit) != 0) == allocated) {
+    return false;
+  }
+  bits_[word] ^= bit;
+  return true;
+}
+
+void FreeSpaceMap::SetAllAllocated(page_id_t end) {
+  std::lock_guard<std::mutex> lg(latch_);
+  auto words = (static_cast<size_t>(end) + 63) / 64;
+  if (words > bits_.size()) {
+    bits_.resize(words, 0);
+  }
+  for (page_id_t page_id = 0; page_id < end; page_id++) {
+    bits_[page_id / 64] |= uint64_t{1} << (page_id % 64);
+  }
+}
+
+auto FreeSpaceMap::GetEnd() const -> page_id_t {
+  std::lock_guard<std::mutex> lg(latch_);
+  for (size_t word = bits_.size(); word > 0; word--) {
+    if (bits_[word - 1] != 0) {
+      return static_cast<page_id_t>(word * 64 - __builtin_clzll(bits_[word - 1]));
+    }
+  }
+  return 0;
+}
+
+auto FreeSpaceMap::GetNumAllocated() const -> size_t {
+  std::lock_guard<std::mutex> lg(latch_);
+  size_t num_allocated = 0;
+  for (auto word : bits_) {
+    num_allocated += __builtin_popcountll(word);
+  }
+  return num_allocated;
+}
+
+auto FreeSpaceMap::Save(const std::string &file_name) const -> bool {
+  std::string tmp_file_name = file_name + ".tmp";
+  {
+    std::lock_guard<std::mutex> lg(latch_);
+    std::ofstream file(tmp_file_name, std::ios::binary | std::ios::trunc);
+    auto num_words = static_cast<uint64_t>(bits_.size());
+    file.write(reinterpret_cast<const char *>(&FREE_SPACE_MAP_MAGIC), sizeof(FREE_SPACE_MAP_MAGIC));
+    file.write(reinterpret_cast<const char *>(&num_words), sizeof(num_words));
+    file.write(reinterpret_cast<const char *>(bits_.data()), bits_.size() * sizeof(uint64_t));
+    if (!file.good()) {
+      LOG_DEBUG("can't write free space map file %s", tmp_file_name.c_str());
+      return false;
+    }
+  }
+  return std::rename(tmp_file_name.c_str(), file_name.c_str()) == 0;
+}
+
+auto FreeSpaceMap::Load(const std::string &file_name) -> bool {
+  std::lock_guard<std::mutex> lg(latch_);
+  bits_.clear();
+  std::ifstream file(file_name, std::ios::binary);
+  uint32_t magic = 0;
+  uint64_t num_words = 0;
+  file.read(reinterpret_cast<char *>(&magic), sizeof(magic));
+  file.read(reinterpret_cast<char *>(&num_words), sizeof(num_words));
+  // page ids are 31 bits
+  if (!file.good() || magic != FREE_SPACE_MAP_MAGIC || num_words > (uint64_t{1} << 31) / 64) {
+    return false;
+  }
+  bits_.resize(num_words);
+  file.read(reinterpret_cast<char *>(bits_.data()), num_words * sizeof(uint64_t));
+  if (!file.good()) {
+    bits_.clear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,215 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksums.cpp
+//
+// Identification: src/storage/disk/page_checksums.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_checksums.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+
+#include "common/logger.h"
+#include "common/util/crc32c.h"
+
+namespace bustub {
+
+namespace {
+/** @return the checksum of a page that was never written, which reads as zeros */
+auto ZeroPageChecksum() -> uint32_t {
+  static const uint32_t checksum = [] {
+    std::vector<char> zeros(PAGE_SIZE, 0);
+    return PageChecksums::Compute(zeros.data());
+  }();
+  return checksum;
+}
+
+/** pwrite all of size bytes at offset, retrying short and interrupted writes. */
+auto PwriteFully(int fd, const char *buf, size_t size, off_t offset) -> bool {
+  while (size > 0) {
+    ssize_t n = pwrite(fd, buf, size, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    buf += n;
+    size -= static_cast<size_t>(n);
+    offset += n;
+  }
+  return true;
+}
+}  // namespace
+
+PageChecksums::PageChecksums() : chunks_(new std::atomic<std::atomic<uint64_t> *>[NUM_CHUNKS]()) {}
+
+PageChecksums::~PageChecksums() {
+  for (size_t i = 0; i < NUM_CHUNKS; i++) {
+    auto *chunk = chunks_[i].load();
+    if (chunk != nullptr && fd_ != -1) {
+      munmap(chunk, CHUNK_SIZE);
+    } else {
+      delete[] chunk;
+    }
+  }
+  if (fd_ != -1) {
+    close(fd_);
+  }
+}
+
+auto PageChecksums::Compute(const char *page_data) -> uint32_t { return Crc32c::Compute(page_data, PAGE_SIZE); }
+
+auto PageChecksums::Open(const std::string &file_name) -> bool {
+  int fd;
+  do {
+    fd = open(file_name.c_str(), O_RDWR | O_CREAT, 0644);  // NOLINT
+  } while (fd == -1 && errno == EINTR);
+  if (fd == -1) {
+    LOG_DEBUG("can't open page checksum file %s", file_name.c_str());
+    return false;
+  }
+  struct stat stat_buf;
+  off_t file_size = fstat(fd, &stat_buf) == 0 ? stat_buf.st_size : 0;
+  uint64_t header = 0;
+  if (file_size < static_cast<off_t>(HEADER_SIZE) || pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+      header != PAGE_CHECKSUMS_MAGIC) {
+    // new, or not a checksum file: start over
+    header = PAGE_CHECKSUMS_MAGIC;
+    if (ftruncate(fd, 0) != 0 || !PwriteFully(fd, reinterpret_cast<const char *>(&header), sizeof(header), 0)) {
+      LOG_DEBUG("can't write page checksum file %s", file_name.c_str());
+      close(fd);
+      return false;
+    }
+    file_size = HEADER_SIZE;
+  }
+  // the chunks are mapped whole, so the file covers whole chunks; what was never written of one reads as zeros
+  auto data_size = static_cast<size_t>(file_size) - HEADER_SIZE;
+  size_t num_chunks = std::min((data_size + CHUNK_SIZE - 1) / CHUNK_SIZE, NUM_CHUNKS);
+  if (ftruncate(fd, static_cast<off_t>(HEADER_SIZE + num_chunks * CHUNK_SIZE)) != 0) {
+    LOG_DEBUG("can't write page checksum file %s", file_name.c_str());
+    close(fd);
+    return false;
+  }
+  std::lock_guard<std::mutex> lg(chunk_latch_);
+  fd_ = fd;
+  num_file_chunks_ = num_chunks;
+  for (size_t i = 0; i < num_chunks; i++) {
+    if (MapChunk(i) != nullptr) {
+      continue;
+    }
+    LOG_DEBUG("can't map page checksum file %s", file_name.c_str());
+    for (size_t j = 0; j < i; j++) {
+      munmap(chunks_[j].exchange(nullptr), CHUNK_SIZE);
+    }
+    close(fd_);
+    fd_ = -1;
+    return false;
+  }
+  return true;
+}
+
+void PageChecksums::Set(page_id_t page_id, uint32_t checksum) {
+  std::lock_guard<std::mutex> lg(GetShardLatch(page_id));
+  uint64_t entry = GetEntry(page_id);
+  // until its first write a page reads as zeros
+  uint32_t previous = entry == 0 ? ZeroPageChecksum() : static_cast<uint32_t>(entry);
+  PutEntry(page_id, static_cast<uint64_t>(previous) << 32 | checksum);
+}
+
+void PageChecksums::Clear(page_id_t page_id) {
+  std::lock_guard<std::mutex> lg(GetShardLatch(page_id));
+  if (GetEntry(page_id) != 0) {
+    PutEntry(page_id, 0);
+  }
+}
+
+auto PageChecksums::Verify(page_id_t page_id, const char *page_data) const -> bool {
+  uint64_t entry = GetEntry(page_id);
+  if (entry == 0) {
+    return true;
+  }
+  uint32_t checksum = Compute(page_data);
+  return checksum == static_cast<uint32_t>(entry) || checksum == static_cast<uint32_t>(entry >> 32);
+}
+
+auto PageChecksums::Sync() -> bool {
+  if (fd_ == -1) {
+    return true;
+  }
+  uint64_t num_puts = num_puts_.load();
+  std::lock_guard<std::mutex> lg(sync_latch_);
+  if (num_synced_puts_ >= num_puts) {
+    return true;
+  }
+  // whatever was stored up to here is covered too; the sync writes back what was stored through the mappings
+  num_puts = num_puts_.load();
+  if (fdatasync(fd_) != 0) {
+    return false;
+  }
+  num_synced_puts_ = num_puts;
+  return true;
+}
+
+auto PageChecksums::GetEntry(page_id_t page_id) const -> uint64_t {
+  const auto *chunk = chunks_[static_cast<size_t>(page_id) / ENTRIES_PER_CHUNK].load(std::memory_order_acquire);
+  if (chunk == nullptr) {
+    return 0;
+  }
+  return chunk[static_cast<size_t>(page_id) % ENTRIES_PER_CHUNK].load(std::memory_order_acquire);
+}
+
+void PageChecksums::PutEntry(page_id_t page_id, uint64_t entry) {
+  auto chunk_index = static_cast<size_t>(page_id) / ENTRIES_PER_CHUNK;
+  auto *chunk = chunks_[chunk_index].load(std::memory_order_acquire);
+  if (chunk == nullptr) {
+    std::lock_guard<std::mutex> lg(chunk_latch_);
+    chunk = chunks_[chunk_index].load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+      chunk = MapChunk(chunk_index);
+    }
+    if (chunk == nullptr) {
+      LOG_DEBUG("I/O error while adding the checksum of page %d", page_id);
+      return;
+    }
+  }
+  // with a file, the chunk is mapped from it: the entry gets there without a system call
+  chunk[static_cast<size_t>(page_id) % ENTRIES_PER_CHUNK].store(entry, std::memory_order_release);
+  num_puts_.fetch_add(1);
+}
+
+auto PageChecksums::MapChunk(size_t chunk_index) -> std::atomic<uint64_t> * {
+  std::atomic<uint64_t> *chunk;
+  if (fd_ == -1) {
+    chunk = new std::atomic<uint64_t>[ENTRIES_PER_CHUNK]();
+  } else {
+    if (chunk_index >= num_file_chunks_) {
+      // a file that grows past its end reads as zeros
+      if (ftruncate(fd_, static_cast<off_t>(HEADER_SIZE + (chunk_index + 1) * CHUNK_SIZE)) != 0) {
+        return nullptr;
+      }
+      num_file_chunks_ = chunk_index + 1;
+    }
+    void *mapped = mmap(nullptr, CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+                        static_cast<off_t>(HEADER_SIZE + chunk_index * CHUNK_SIZE));
+    if (mapped == MAP_FAILED) {
+      return nullptr;
+    }
+    chunk = static_cast<std::atomic<uint64_t> *>(mapped);
+  }
+  chunks_[chunk_index].store(chunk, std::memory_order_release);
+  return chunk;
+}
+
+}  // namespace bustub
@@ -11,6 +11,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_bucket_page.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "common/logger.h"
 #include "common/util/hash_util.h"
 #include "storage/index/generic_key.h"
@@ -19,15 +29,75 @@
 
 namespace bustub {
 
+namespace {
+/** Number of slots whose fingerprints are compared at once. Groups start at multiples of it. */
+#if defined(__AVX2__)
+constexpr uint32_t GROUP_SIZE = 32;
+#else
+constexpr uint32_t GROUP_SIZE = 16;
+#endif
+/** The bits of a whole group. */
+constexpr uint32_t GROUP_MASK = GROUP_SIZE == 32 ? ~0U : (1U << GROUP_SIZE) - 1;
+
+/**
+ * Compare the fingerprints of a group. The group may extend past the last slot: the loads stay within the page, which
+ * the key/value array follows, and the slots past the end are never readable.
+ * @return bit i set if the fingerprint of slot i of the group is fingerprint
+ */
+auto MatchFingerprints(const uint8_t *group, uint8_t fingerprint) -> uint32_t {
+#if defined(__AVX2__)
+  __m256i fingerprints = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(group));
+  __m256i matches = _mm256_cmpeq_epi8(fingerprints, _mm256_set1_epi8(static_cast<char>(fingerprint)));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+#elif defined(__SSE2__)
+  __m128i fingerprints = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  __m128i matches = _mm_cmpeq_epi8(fingerprints, _mm_set1_epi8(static_cast<char>(fingerprint)));
+  return static_cast<uint32_t>(_mm_movemask_epi8(matches));
+#else
+  uint32_t matches = 0;
+  for (uint32_t i = 0; i < GROUP_SIZE; i++) {
+    matches |= static_cast<uint32_t>(group[i] == fingerprint) << i;
+  }
+  return matches;
+#endif
+}
+
+/**
+ * @param bitmap occupied_ or readable_
+ * @param size the size of the bitmap in bytes
+ * @param first_slot the first slot of a group
+ * @return bit i set if bit first_slot + i of the bitmap is set
+ */
+auto LoadGroupBits(const char *bitmap, size_t size, uint32_t first_slot) -> uint32_t {
+  uint32_t bits = 0;
+  memcpy(&bits, bitmap + first_slot / 8, std::min<size_t>(GROUP_SIZE / 8, size - first_slot / 8));
+  return bits & GROUP_MASK;
+}
+}  // namespace
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::Fingerprint(const KeyType &key) -> uint8_t {
+  hash_t hash = HashUtil::HashBytes(reinterpret_cast<const char *>(&key), sizeof(KeyType));
+  // HashBytes leaves the last bytes of the key in the low bits: a multiplicative hash spreads all of them to the top
+  return static_cast<uint8_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL) >> 56);
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
+  const uint8_t fingerprint = Fingerprint(key);
   bool done = false;
-  for (size_t i = 0; i < BUCKET_ARRAY_SIZE; ++i) {
-    if (IsReadable(i) && cmp(array_[i].first, key) == 0) {
-      result->push_back(array_[i].second);
-      done = true;
+  for (uint32_t first = 0; first < BUCKET_ARRAY_SIZE; first += GROUP_SIZE) {
+    uint32_t candidates =
+        MatchFingerprints(fingerprints_ + first, fingerprint) & LoadGroupBits(readable_, sizeof(readable_), first);
+    for (; candidates != 0; candidates &= candidates - 1) {
+      uint32_t i = first + __builtin_ctz(candidates);
+      if (cmp(array_[i].first, key) == 0) {
+        result->push_back(array_[i].second);
+        done = true;
+      }
     }
-    if (!IsOccupied(i)) {
+    // nothing was ever stored past the first slot that is not occupied
+    if (LoadGroupBits(occupied_, sizeof(occupied_), first) != GROUP_MASK) {
       break;
     }
   }
@@ -36,25 +106,29 @@ auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vecto
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+  const uint8_t fingerprint = Fingerprint(key);
   uint32_t idx = BUCKET_ARRAY_SIZE;
-  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (IsReadable(i)) {
-      if (cmp(array_[i].first, key) == 0 && ValueAt(i) == value) {
+  for (uint32_t first = 0; first < BUCKET_ARRAY_SIZE; first += GROUP_SIZE) {
+    uint32_t readable = LoadGroupBits(readable_, sizeof(readable_), first);
+    for (uint32_t candidates = MatchFingerprints(fingerprints_ + first, fingerprint) & readable; candidates != 0;
+         candidates &= candidates - 1) {
+      uint32_t i = first + __builtin_ctz(candidates);
+      if (cmp(array_[i].first, key) == 0 && array_[i].second == value) {
         return false;
       }
-    } else {
-      if (idx == BUCKET_ARRAY_SIZE) {
-        idx = i;
-      }
-      if (!IsOccupied(i)) {
-        break;
-      }
+    }
+    if (idx == BUCKET_ARRAY_SIZE && readable != GROUP_MASK) {
+      idx = std::min<uint32_t>(first + __builtin_ctz(~readable), BUCKET_ARRAY_SIZE);
+    }
+    if (LoadGroupBits(occupied_, sizeof(occupied_), first) != GROUP_MASK) {
+      break;
     }
   }
   if (idx == BUCKET_ARRAY_SIZE) {
     return false;
   }
   array_[idx] = {key, value};
+  fingerprints_[idx] = fingerprint;
   SetOccupied(idx);
   SetReadable(idx);
   return true;
@@ -62,12 +136,18 @@ auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
-  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
-    if (IsReadable(i) && cmp(KeyAt(i), key) == 0 && value == ValueAt(i)) {
-      RemoveAt(i);
-      return true;
+  const uint8_t fingerprint = Fingerprint(key);
+  for (uint32_t first = 0; first < BUCKET_ARRAY_SIZE; first += GROUP_SIZE) {
+    uint32_t candidates =
+        MatchFingerprints(fingerprints_ + first, fingerprint) & LoadGroupBits(readable_, sizeof(readable_), first);
+    for (; candidates != 0; candidates &= candidates - 1) {
+      uint32_t i = first + __builtin_ctz(candidates);
+      if (cmp(array_[i].first, key) == 0 && array_[i].second == value) {
+        RemoveAt(i);
+        return true;
+      }
     }
-    if (!IsOccupied(i)) {
+    if (LoadGroupBits(occupied_, sizeof(occupied_), first) != GROUP_MASK) {
       break;
     }
   }
@@ -127,37 +207,26 @@ void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  uint32_t size = BUCKET_ARRAY_SIZE / 8;
-  for (uint32_t i = 0; i < size; i++) {
-    if (readable_[i] != static_cast<char>(0xff)) {
-      return false;
-    }
-  }
-  uint32_t remainder = BUCKET_ARRAY_SIZE - size * 8;
-  return !(remainder != 0 && readable_[size] != static_cast<char>((1 << remainder) - 1));
+  return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
   uint32_t count = 0;
-  uint32_t size = (BUCKET_ARRAY_SIZE - 1) / 8 + 1;
-
-  uint8_t n;
-  for (uint32_t i = 0; i < size; i++) {
-    n = static_cast<uint8_t>(readable_[i]);
-    while (n != 0) {
-      n &= (n - 1);
-      count++;
-    }
+  for (size_t i = 0; i < sizeof(readable_); i += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, readable_ + i, std::min(sizeof(word), sizeof(readable_) - i));
+    count += __builtin_popcountll(word);
   }
   return count;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  uint32_t read_array_size = (BUCKET_ARRAY_SIZE - 1) / 8 + 1;
-  for (uint32_t i = 0; i < read_array_size; i++) {
-    if (readable_[i] != static_cast<char>(0)) {
+  for (size_t i = 0; i < sizeof(readable_); i += sizeof(uint64_t)) {
+    uint64_t word = 0;
+    memcpy(&word, readable_ + i, std::min(sizeof(word), sizeof(readable_) - i));
+    if (word != 0) {
       return false;
     }
   }
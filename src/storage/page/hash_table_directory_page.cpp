@@ -31,10 +31,11 @@ auto HashTableDirectoryPage::GetGlobalDepthMask() -> uint32_t {
 }
 
 auto HashTableDirectoryPage::GetLocalDepthMask(uint32_t bucket_idx) -> uint32_t {
-  return (1 << local_depths_[bucket_idx]) - 1;
+  return (1 << local_depths_[bucket_idx % DIRECTORY_ARRAY_SIZE]) - 1;
 }
 
 void HashTableDirectoryPage::IncrGlobalDepth() {
+  assert(Size() < DIRECTORY_ARRAY_SIZE);
   size_t n = Size();
   for (size_t i = 0; i < n; i++) {
     bucket_page_ids_[i + n] = bucket_page_ids_[i];
@@ -48,10 +49,12 @@ void HashTableDirectoryPage::DecrGlobalDepth() {
   global_depth_--;
 }
 
-auto HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) -> page_id_t { return bucket_page_ids_[bucket_idx]; }
+auto HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) -> page_id_t {
+  return bucket_page_ids_[bucket_idx % DIRECTORY_ARRAY_SIZE];
+}
 
 void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {
-  bucket_page_ids_[bucket_idx] = bucket_page_id;
+  bucket_page_ids_[bucket_idx % DIRECTORY_ARRAY_SIZE] = bucket_page_id;
 }
 
 auto HashTableDirectoryPage::Size() -> uint32_t { return static_cast<uint32_t>(1 << global_depth_); }
@@ -65,25 +68,27 @@ auto HashTableDirectoryPage::CanShrink() -> bool {
   return true;
 }
 
-auto HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) -> uint32_t { return local_depths_[bucket_idx]; }
+auto HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) -> uint32_t {
+  return local_depths_[bucket_idx % DIRECTORY_ARRAY_SIZE];
+}
 
 void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint8_t local_depth) {
-  local_depths_[bucket_idx] = local_depth;
+  local_depths_[bucket_idx % DIRECTORY_ARRAY_SIZE] = local_depth;
 }
 
-void HashTableDirectoryPage::IncrLocalDepth(uint32_t bucket_idx) { local_depths_[bucket_idx]++; }
+void HashTableDirectoryPage::IncrLocalDepth(uint32_t bucket_idx) { local_depths_[bucket_idx % DIRECTORY_ARRAY_SIZE]++; }
 
-void HashTableDirectoryPage::DecrLocalDepth(uint32_t bucket_idx) { local_depths_[bucket_idx]--; }
+void HashTableDirectoryPage::DecrLocalDepth(uint32_t bucket_idx) { local_depths_[bucket_idx % DIRECTORY_ARRAY_SIZE]--; }
 
 auto HashTableDirectoryPage::GetLocalHighBit(uint32_t bucket_idx) -> uint32_t {
-  return ((1 << local_depths_[bucket_idx]) - 1) & bucket_idx;
+  return ((1 << local_depths_[bucket_idx % DIRECTORY_ARRAY_SIZE]) - 1) & bucket_idx;
 }
 
 auto HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) -> uint32_t {
-  if (local_depths_[bucket_idx] == 0) {
+  if (local_depths_[bucket_idx % DIRECTORY_ARRAY_SIZE] == 0) {
     return 0;
   }
-  return bucket_idx ^ (1 << (local_depths_[bucket_idx] - 1));
+  return bucket_idx ^ (1 << (local_depths_[bucket_idx % DIRECTORY_ARRAY_SIZE] - 1));
 }
 
 /**
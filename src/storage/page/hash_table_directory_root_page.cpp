@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_root_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_root_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_directory_root_page.h"
+
+#include <algorithm>
+
+namespace bustub {
+auto HashTableDirectoryRootPage::GetPageId() const -> page_id_t { return page_id_; }
+
+void HashTableDirectoryRootPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+auto HashTableDirectoryRootPage::GetLSN() const -> lsn_t { return lsn_; }
+
+void HashTableDirectoryRootPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+auto HashTableDirectoryRootPage::GetGlobalDepth() -> uint32_t { return global_depth_; }
+
+auto HashTableDirectoryRootPage::GetGlobalDepthMask() -> uint32_t {
+  return static_cast<uint32_t>((1 << global_depth_) - 1);
+}
+
+void HashTableDirectoryRootPage::IncrGlobalDepth() {
+  assert(CanGrow());
+  global_depth_++;
+}
+
+void HashTableDirectoryRootPage::DecrGlobalDepth() {
+  assert(global_depth_ > 0);
+  global_depth_--;
+}
+
+auto HashTableDirectoryRootPage::CanGrow() -> bool { return global_depth_ < DIRECTORY_MAX_DEPTH; }
+
+auto HashTableDirectoryRootPage::Size() -> uint32_t { return static_cast<uint32_t>(1 << global_depth_); }
+
+auto HashTableDirectoryRootPage::NumDirectoryPages() -> uint32_t {
+  return std::max<uint32_t>(Size() / DIRECTORY_ARRAY_SIZE, 1);
+}
+
+auto HashTableDirectoryRootPage::NumSegments() -> uint32_t {
+  return (NumDirectoryPages() + DIRECTORY_SEGMENT_ARRAY_SIZE - 1) / DIRECTORY_SEGMENT_ARRAY_SIZE;
+}
+
+auto HashTableDirectoryRootPage::GetDirectoryIndex(uint32_t bucket_idx) -> uint32_t {
+  return bucket_idx / DIRECTORY_ARRAY_SIZE;
+}
+
+auto HashTableDirectoryRootPage::GetSegmentIndex(uint32_t directory_idx) -> uint32_t {
+  return directory_idx / DIRECTORY_SEGMENT_ARRAY_SIZE;
+}
+
+auto HashTableDirectoryRootPage::GetSegmentPageId(uint32_t segment_idx) -> page_id_t {
+  return segment_page_ids_[segment_idx];
+}
+
+void HashTableDirectoryRootPage::SetSegmentPageId(uint32_t segment_idx, page_id_t segment_page_id) {
+  segment_page_ids_[segment_idx] = segment_page_id;
+}
+
+}  // namespace bustub
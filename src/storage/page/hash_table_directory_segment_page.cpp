@@ -0,0 +1,32 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_segment_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_segment_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_directory_segment_page.h"
+
+namespace bustub {
+auto HashTableDirectorySegmentPage::GetPageId() const -> page_id_t { return page_id_; }
+
+void HashTableDirectorySegmentPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+auto HashTableDirectorySegmentPage::GetLSN() const -> lsn_t { return lsn_; }
+
+void HashTableDirectorySegmentPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+auto HashTableDirectorySegmentPage::GetDirectoryPageId(uint32_t directory_idx) -> page_id_t {
+  return directory_page_ids_[directory_idx % DIRECTORY_SEGMENT_ARRAY_SIZE];
+}
+
+void HashTableDirectorySegmentPage::SetDirectoryPageId(uint32_t directory_idx, page_id_t directory_page_id) {
+  directory_page_ids_[directory_idx % DIRECTORY_SEGMENT_ARRAY_SIZE] = directory_page_id;
+}
+
+}  // namespace bustub
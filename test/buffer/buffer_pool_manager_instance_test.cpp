@@ -14,6 +14,8 @@
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -77,11 +79,10 @@ TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
   EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
   EXPECT_EQ(true, bpm->UnpinPage(0, true));
 
+  delete bpm;
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
-
-  delete bpm;
   delete disk_manager;
 }
 
@@ -133,12 +134,781 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
   EXPECT_EQ(nullptr, bpm->FetchPage(0));
 
+  delete bpm;
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  delete disk_manager;
+}
+
+// Misses on the same page from several threads must all see the page contents, not a half-read frame.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const int num_pages = 50;
+  const int num_threads = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+      char expected[PAGE_SIZE];
+      for (int i = 0; i < 200; ++i) {
+        auto page_id = page_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          // every frame is pinned by the other threads right now
+          continue;
+        }
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// A clean unpin must not discard an earlier writer's changes, and the background writer should clean dirty frames.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DirtyTrackingTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+
+  // Scenario: a reader fetches page 0 and unpins it clean; the page must stay dirty.
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_TRUE(page0->IsDirty() || disk_manager->GetNumWrites() > 0);
+
+  // Scenario: the background writer picks up the dirty page without anything being evicted.
+  for (int i = 0; i < 100 && disk_manager->GetNumWrites() == 0; ++i) {
+    std::this_thread::sleep_for(background_writer_interval);
+  }
+  EXPECT_EQ(1, disk_manager->GetNumWrites());
+  EXPECT_FALSE(page0->IsDirty());
+
+  // Scenario: evict page 0 and read it back.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// A deleted page can't be fetched back in, which would map its id to a second frame once it is handed out again.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, DeletedPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  EXPECT_TRUE(bpm->DeletePage(page_id));
+  EXPECT_EQ(nullptr, bpm->FetchPage(page_id));
+  std::vector<Page *> pages;
+  bpm->FetchPages({page_id}, &pages);
+  EXPECT_EQ(nullptr, pages[0]);
+
+  // Scenario: the id is handed out again, and fetching it finds the new page.
+  page_id_t new_page_id;
+  auto *page = bpm->NewPage(&new_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(page_id, new_page_id);
+  snprintf(page->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_EQ(page, bpm->FetchPage(page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
 
   delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// Pages left dirty in the pool, below the background writer's watermark, must be written back when it is destroyed,
+// which has to happen before its disk manager is shut down.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushOnDestructionTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 50;
+  const int num_pages = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: the pages are on disk, as a fresh disk manager over the same file reads them back.
+  disk_manager = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  char expected[PAGE_SIZE];
+  for (int i = 0; i < num_pages; ++i) {
+    EXPECT_TRUE(disk_manager->ReadPage(i, data));
+    snprintf(expected, PAGE_SIZE, "Page %d", i);
+    EXPECT_EQ(0, strcmp(data, expected));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FlushAllTest) {
+  const size_t buffer_pool_size = 16;
+  // keep the background writer out of the way
+  double dirty_ratio = background_writer_dirty_ratio;
+  background_writer_dirty_ratio = 2;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  std::vector<Page *> pages;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    pages.push_back(page);
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(static_cast<page_id_t>(i), true));
+  }
+  for (size_t i = 1; i < buffer_pool_size; i += 2) {
+    EXPECT_EQ(pages[i], bpm->FetchPage(static_cast<page_id_t>(i)));
+  }
+
+  // Scenario: the dirty pages, pinned or not, go to disk as one run of adjacent pages.
+  bpm->FlushAllPages();
+  EXPECT_EQ(buffer_pool_size, disk_manager->GetNumWrites());
+  EXPECT_EQ(1, disk_manager->GetNumVectoredWrites());
+  char data[PAGE_SIZE];
+  char expected[PAGE_SIZE];
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_FALSE(pages[i]->IsDirty());
+    EXPECT_TRUE(disk_manager->ReadPage(static_cast<page_id_t>(i), data));
+    snprintf(expected, PAGE_SIZE, "page %zu", i);
+    EXPECT_EQ(0, strcmp(data, expected));
+  }
+
+  // Scenario: clean pages are not written again.
+  bpm->FlushAllPages();
+  EXPECT_EQ(buffer_pool_size, disk_manager->GetNumWrites());
+  for (size_t i = 1; i < buffer_pool_size; i += 2) {
+    EXPECT_TRUE(bpm->UnpinPage(static_cast<page_id_t>(i), false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  background_writer_dirty_ratio = dirty_ratio;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, SequentialScanTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_scan_pages = 40;
+  const int num_hot_pages = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_scan_pages + num_hot_pages; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  // Tag the hot pages without marking them dirty: the tag only survives as long as the page stays resident.
+  auto touch_hot_pages = [&]() {
+    for (page_id_t page_id = num_scan_pages; page_id < num_scan_pages + num_hot_pages; ++page_id) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "hot");
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  };
+  auto count_resident_hot_pages = [&]() {
+    int resident = 0;
+    for (page_id_t page_id = num_scan_pages; page_id < num_scan_pages + num_hot_pages; ++page_id) {
+      auto *page = bpm->FetchPage(page_id);
+      resident += page != nullptr && strcmp(page->GetData(), "hot") == 0 ? 1 : 0;
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+    return resident;
+  };
+
+  // Scenario: a sequential scan over more pages than the pool holds leaves the hot pages alone.
+  touch_hot_pages();
+  for (page_id_t page_id = 0; page_id < num_scan_pages; ++page_id) {
+    EXPECT_NE(nullptr, bpm->FetchPage(page_id, AccessStrategy::SEQUENTIAL));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(num_hot_pages, count_resident_hot_pages());
+
+  // Scenario: the same scan with normal accesses flushes them out.
+  touch_hot_pages();
+  for (page_id_t page_id = 0; page_id < num_scan_pages; ++page_id) {
+    EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, count_resident_hot_pages());
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// Concurrent scans of an instance share its sequential ring: together they still only take the ring's frames.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, SharedRingTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_scan_pages = 20;
+  const int num_hot_pages = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 2 * num_scan_pages + num_hot_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  const page_id_t first_hot_page_id = 2 * num_scan_pages;
+  for (page_id_t page_id = first_hot_page_id; page_id < first_hot_page_id + num_hot_pages; ++page_id) {
+    EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  auto is_resident = [&](page_id_t page_id) {
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      if (bpm->GetPages()[i].GetPageId() == page_id) {
+        return true;
+      }
+    }
+    return false;
+  };
+  char expected[PAGE_SIZE];
+  auto scan_page = [&](page_id_t page_id) {
+    auto *page = bpm->FetchPage(page_id, AccessStrategy::SEQUENTIAL);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  };
+
+  // Scenario: two scans over different pages take turns. Each one's misses recycle the frames the other just left.
+  for (page_id_t page_id = 0; page_id < num_scan_pages; ++page_id) {
+    scan_page(page_id);
+    scan_page(num_scan_pages + page_id);
+  }
+  for (page_id_t page_id = first_hot_page_id; page_id < first_hot_page_id + num_hot_pages; ++page_id) {
+    EXPECT_TRUE(is_resident(page_id));
+  }
+
+  // Scenario: a scan holding on to its page keeps it while the other scan cycles through the rest of the ring.
+  auto *held_page = bpm->FetchPage(0, AccessStrategy::SEQUENTIAL);
+  ASSERT_NE(nullptr, held_page);
+  for (page_id_t page_id = num_scan_pages; page_id < 2 * num_scan_pages; ++page_id) {
+    scan_page(page_id);
+  }
+  EXPECT_EQ(0, held_page->GetPageId());
+  EXPECT_EQ(0, strcmp(held_page->GetData(), "page 0"));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  for (page_id_t page_id = first_hot_page_id; page_id < first_hot_page_id + num_hot_pages; ++page_id) {
+    EXPECT_TRUE(is_resident(page_id));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ReadAheadTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const int num_pages = 40;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  // Push all of them out of the pool.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  auto is_resident = [&](page_id_t page_id) {
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      if (bpm->GetPages()[i].GetPageId() == page_id) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // Scenario: two fetches in page order start reading the following pages in the background.
+  char expected[PAGE_SIZE];
+  ScanHandle scan;
+  for (page_id_t page_id = 0; page_id < 2; ++page_id) {
+    auto *page = bpm->FetchScanPage(page_id, &scan);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (int i = 0; i < 100 && !is_resident(2); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_TRUE(is_resident(2));
+
+  // Scenario: the rest of the scan sees the right data, wherever it was read from.
+  for (page_id_t page_id = 2; page_id < num_pages; ++page_id) {
+    auto *page = bpm->FetchScanPage(page_id, &scan);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, InterleavedReadAheadTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const int num_pages = 40;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  // Push all of them out of the pool.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  auto is_resident = [&](page_id_t page_id) {
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      if (bpm->GetPages()[i].GetPageId() == page_id) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // Scenario: two scans of different halves of the pages take turns fetching; each is read ahead past its position.
+  ScanHandle first_scan;
+  ScanHandle second_scan;
+  const page_id_t second_start = num_pages / 2;
+  for (page_id_t offset = 0; offset < 2; ++offset) {
+    ASSERT_NE(nullptr, bpm->FetchScanPage(offset, &first_scan));
+    EXPECT_TRUE(bpm->UnpinPage(offset, false));
+    ASSERT_NE(nullptr, bpm->FetchScanPage(second_start + offset, &second_scan));
+    EXPECT_TRUE(bpm->UnpinPage(second_start + offset, false));
+  }
+  for (int i = 0; i < 100 && !(is_resident(2) && is_resident(second_start + 2)); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_TRUE(is_resident(2));
+  EXPECT_TRUE(is_resident(second_start + 2));
+  EXPECT_GE(bpm->GetStats().prefetches_, 2);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, OptimisticReadTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  uint64_t version;
+
+  // Scenario: pages that are not resident cannot be read optimistically.
+  EXPECT_EQ(nullptr, bpm->OptimisticFetchPage(0, &version));
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+
+  // Scenario: an unpinned, resident page can be read and validated.
+  auto *page = bpm->OptimisticFetchPage(0, &version);
+  ASSERT_EQ(page0, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "Hello"));
+  EXPECT_TRUE(page->ValidateVersion(version));
+  EXPECT_EQ(0, page->GetPinCount());
+
+  // Scenario: a writer invalidates the read, and a read cannot start while the writer holds the latch.
+  page = bpm->OptimisticFetchPage(0, &version);
+  ASSERT_NE(nullptr, page);
+  page0 = bpm->FetchPage(0);
+  page0->WLatch();
+  EXPECT_FALSE(page->ValidateVersion(version));
+  EXPECT_EQ(nullptr, bpm->OptimisticFetchPage(0, &version));
+  page0->WUnlatch();
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+
+  // Scenario: evicting the page invalidates the read as well.
+  page = bpm->OptimisticFetchPage(0, &version);
+  ASSERT_NE(nullptr, page);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_FALSE(page->ValidateVersion(version));
+  EXPECT_EQ(nullptr, bpm->OptimisticFetchPage(0, &version));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, BatchFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 8; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  // keep the background writer from pinning frames while the pool is exactly full
+  bpm->FlushAllPages();
+
+  // Scenario: a batch of hits (pages 6 and 7) and misses (pages 0 and 1), with a duplicate.
+  std::vector<page_id_t> page_ids{6, 0, 7, 1, 0};
+  std::vector<Page *> pages;
+  bpm->FetchPages(page_ids, &pages);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  char expected[PAGE_SIZE];
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    snprintf(expected, PAGE_SIZE, "page %d", page_ids[i]);
+    EXPECT_EQ(0, strcmp(pages[i]->GetData(), expected));
+  }
+  EXPECT_EQ(pages[1], pages[4]);
+  EXPECT_EQ(2, pages[1]->GetPinCount());
+
+  // Scenario: every frame is pinned, so a batch of other pages cannot be fetched.
+  bpm->FetchPages({2, 3}, &pages);
+  EXPECT_EQ(nullptr, pages[0]);
+  EXPECT_EQ(nullptr, pages[1]);
+
+  // Scenario: unpin the whole batch; unpinning it again fails.
+  EXPECT_TRUE(bpm->UnpinPages(page_ids, false));
+  EXPECT_FALSE(bpm->UnpinPages({6, 7}, false));
+  bpm->FetchPages({2, 3}, &pages);
+  ASSERT_NE(nullptr, pages[0]);
+  ASSERT_NE(nullptr, pages[1]);
+  EXPECT_EQ(0, strcmp(pages[1]->GetData(), "page 3"));
+  EXPECT_TRUE(bpm->UnpinPages({2, 3}, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, CorruptPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name, false, true);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < 8; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  // flip a byte of pages 0 and 1, which have been evicted
+  FILE *file = fopen(db_name.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  for (long page_id = 0; page_id < 2; ++page_id) {  // NOLINT
+    ASSERT_EQ(0, fseek(file, page_id * PAGE_SIZE, SEEK_SET));
+    ASSERT_EQ(1, fwrite("X", 1, 1, file));
+  }
+  fclose(file);
+
+  // Scenario: a page that does not match its checksum is not handed out, and its frame is not lost.
+  EXPECT_EQ(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(1, disk_manager->GetNumChecksumFailures());
+  std::vector<Page *> pages;
+  bpm->FetchPages({4, 5, 6, 7}, &pages);
+  for (auto *page : pages) {
+    ASSERT_NE(nullptr, page);
+  }
+  EXPECT_TRUE(bpm->UnpinPages({4, 5, 6, 7}, false));
+
+  // Scenario: the same for a batch, where the page is asked for twice.
+  bpm->FetchPages({1, 2, 1}, &pages);
+  EXPECT_EQ(nullptr, pages[0]);
+  ASSERT_NE(nullptr, pages[1]);
+  EXPECT_EQ(0, strcmp(pages[1]->GetData(), "page 2"));
+  EXPECT_EQ(nullptr, pages[2]);
+  EXPECT_EQ(2, disk_manager->GetNumChecksumFailures());
+  EXPECT_TRUE(bpm->UnpinPage(2, false));
+  bpm->FetchPages({4, 5, 6, 7}, &pages);
+  for (auto *page : pages) {
+    ASSERT_NE(nullptr, page);
+  }
+  EXPECT_TRUE(bpm->UnpinPages({4, 5, 6, 7}, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.crc");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t max_pool_size = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU, max_pool_size);
+
+  // Scenario: a full pool of pinned pages can grow and then hold more pages.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(max_pool_size, bpm->ResizePool(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (size_t i = buffer_pool_size; i < max_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+    snprintf(bpm->FetchPage(page_id)->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    if (page_id != 6) {
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  // keep the background writer from pinning frames while the pool shrinks
+  bpm->FlushAllPages();
+  EXPECT_EQ(max_pool_size, bpm->ResizePool(2 * max_pool_size));
+
+  // Scenario: a pinned page stops the pool from shrinking past its frame. The page in the last frame (dirtied again)
+  // is written back and moves to the frame page 0 was deleted from.
+  EXPECT_TRUE(bpm->DeletePage(0));
+  ASSERT_NE(nullptr, bpm->FetchPage(7));
+  EXPECT_TRUE(bpm->UnpinPage(7, true));
+  EXPECT_EQ(max_pool_size - 1, bpm->ResizePool(2));
+  EXPECT_EQ(bpm->GetPages() + 0, bpm->FetchPage(7));
+  EXPECT_EQ(0, strcmp(bpm->GetPages()[0].GetData(), "page 7"));
+  EXPECT_TRUE(bpm->UnpinPage(7, false));
+
+  // Scenario: once the page is unpinned the pool shrinks all the way, and every page is still there.
+  EXPECT_TRUE(bpm->UnpinPage(6, false));
+  EXPECT_EQ(2, bpm->ResizePool(2));
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id = 1; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  ASSERT_NE(nullptr, bpm->FetchPage(2));
+  EXPECT_EQ(nullptr, bpm->FetchPage(3));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+  EXPECT_TRUE(bpm->UnpinPage(2, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, SwizzleTest) {
+  struct RecordingOwner : public SwizzleOwner {
+    void Unswizzle(Page *page) override { unswizzled_.push_back(page); }
+    std::vector<Page *> unswizzled_;
+  };
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(2, disk_manager);
+  RecordingOwner owner;
+  RecordingOwner other_owner;
+
+  page_id_t page_id_0;
+  page_id_t page_id_1;
+  Page *page_0 = bpm->NewPage(&page_id_0);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_1));
+  EXPECT_TRUE(bpm->SwizzlePage(page_0, &owner));
+  EXPECT_TRUE(bpm->SwizzlePage(page_0, &owner));
+  EXPECT_FALSE(bpm->SwizzlePage(page_0, &other_owner));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_0, false));
+
+  // Scenario: a swizzled reference pins the page as long as the frame holds it, and only that page.
+  EXPECT_EQ(page_0, bpm->FetchSwizzledPage(page_0, page_id_0));
+  EXPECT_EQ(1, page_0->GetPinCount());
+  EXPECT_EQ(nullptr, bpm->FetchSwizzledPage(page_0, page_id_1));
+  EXPECT_EQ(1, page_0->GetPinCount());
+  Page foreign_page;
+  EXPECT_EQ(nullptr, bpm->FetchSwizzledPage(&foreign_page, page_id_0));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_0, false));
+  EXPECT_TRUE(owner.unswizzled_.empty());
+
+  // Scenario: evicting the page unswizzles it first; the stale reference then fails.
+  page_id_t page_id_2;
+  ASSERT_EQ(page_0, bpm->NewPage(&page_id_2));
+  EXPECT_EQ(std::vector<Page *>{page_0}, owner.unswizzled_);
+  EXPECT_EQ(nullptr, bpm->FetchSwizzledPage(page_0, page_id_0));
+  EXPECT_TRUE(bpm->SwizzlePage(page_0, &other_owner));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_2, false));
+
+  // Scenario: deleting a page unswizzles it too, unless its owner has left.
+  bpm->UnswizzleAll(&other_owner);
+  EXPECT_TRUE(bpm->DeletePage(page_id_2));
+  EXPECT_TRUE(other_owner.unswizzled_.empty());
+  EXPECT_TRUE(bpm->SwizzlePage(bpm->GetPages() + 1, &owner));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_1, false));
+  EXPECT_TRUE(bpm->DeletePage(page_id_1));
+  EXPECT_EQ(2, owner.unswizzled_.size());
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  // keep the background writer from cleaning (and briefly pinning) the victims
+  double dirty_ratio = background_writer_dirty_ratio;
+  background_writer_dirty_ratio = 2;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(2, disk_manager);
+
+  page_id_t page_id_0;
+  page_id_t page_id_1;
+  page_id_t page_id_2;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_0));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_1));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_0, true));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_1, true));
+  ASSERT_NE(nullptr, bpm->FetchPage(page_id_0));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_0, false));
+  // evicts page 1, then fetching page 1 evicts page 0
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_2));
+  ASSERT_NE(nullptr, bpm->FetchPage(page_id_1));
+
+  // Scenario: the snapshot counts hits, misses, evictions and the write-backs of the dirty victims.
+  std::vector<BufferPoolStats> instance_stats;
+  BufferPoolStats stats = bpm->GetStats(&instance_stats);
+  ASSERT_EQ(1, instance_stats.size());
+  EXPECT_EQ(0, instance_stats[0].instance_index_);
+  EXPECT_EQ(2, stats.pool_size_);
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_DOUBLE_EQ(0.5, stats.HitRatio());
+  EXPECT_EQ(0, stats.prefetches_);
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(2, stats.eviction_writes_);
+  EXPECT_EQ(0, stats.background_writes_);
+  EXPECT_EQ(2, stats.victim_searches_);
+  EXPECT_GE(stats.victim_search_steps_, 2);
+  EXPECT_NE(std::string::npos, stats.ToString().find("hits=1 misses=1"));
+
+  EXPECT_TRUE(bpm->UnpinPage(page_id_1, false));
+  EXPECT_TRUE(bpm->UnpinPage(page_id_2, false));
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
   delete disk_manager;
+  background_writer_dirty_ratio = dirty_ratio;
 }
 
 }  // namespace bustub
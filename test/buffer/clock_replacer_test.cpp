@@ -19,7 +19,7 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +59,39 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, ConcurrencyTest) {
+  const int num_threads = 4;
+  const int frames_per_thread = 16;
+  ClockReplacer clock_replacer(num_threads * frames_per_thread);
+
+  // Scenario: every thread pins and unpins its own frames concurrently. Afterwards all frames are in the replacer and
+  // each of them is victimized exactly once.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&clock_replacer, tid] {
+      for (int round = 0; round < 1000; round++) {
+        for (int i = 0; i < frames_per_thread; i++) {
+          clock_replacer.Pin(tid * frames_per_thread + i);
+          clock_replacer.Unpin(tid * frames_per_thread + i);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(num_threads * frames_per_thread, clock_replacer.Size());
+  std::vector<bool> victimized(num_threads * frames_per_thread, false);
+  int value;
+  while (clock_replacer.Victim(&value)) {
+    EXPECT_FALSE(victimized[value]);
+    victimized[value] = true;
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+  for (auto frame_victimized : victimized) {
+    EXPECT_TRUE(frame_victimized);
+  }
+}
+
 }  // namespace bustub
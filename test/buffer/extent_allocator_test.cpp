@@ -0,0 +1,272 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator_test.cpp
+//
+// Identification: test/buffer/extent_allocator_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/extent_allocator.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExtentAllocatorTest, FreeSpaceMapTest) {
+  const std::string fsm_name = "test_free_space_map.fsm";
+  FreeSpaceMap map;
+  EXPECT_TRUE(map.SetAllocated(3, true));
+  EXPECT_FALSE(map.SetAllocated(3, true));
+  EXPECT_TRUE(map.SetAllocated(100, true));
+  EXPECT_TRUE(map.IsAllocated(3));
+  EXPECT_FALSE(map.IsAllocated(4));
+  EXPECT_FALSE(map.IsAllocated(1000));
+  EXPECT_EQ(2, map.GetNumAllocated());
+  EXPECT_EQ(101, map.GetEnd());
+
+  // Scenario: the map survives a save and load.
+  ASSERT_TRUE(map.Save(fsm_name));
+  FreeSpaceMap loaded;
+  ASSERT_TRUE(loaded.Load(fsm_name));
+  EXPECT_TRUE(loaded.IsAllocated(3));
+  EXPECT_TRUE(loaded.IsAllocated(100));
+  EXPECT_EQ(2, loaded.GetNumAllocated());
+  EXPECT_TRUE(loaded.SetAllocated(100, false));
+  EXPECT_EQ(4, loaded.GetEnd());
+  remove(fsm_name.c_str());
+
+  // Scenario: a missing file leaves the map empty.
+  EXPECT_FALSE(loaded.Load(fsm_name));
+  EXPECT_EQ(0, loaded.GetNumAllocated());
+}
+
+// NOLINTNEXTLINE
+TEST(ExtentAllocatorTest, AllocateTest) {
+  FreeSpaceMap map;
+  auto router = PageRouter::Create(RoutingType::MODULO, 1);
+  ExtentAllocator allocator(&map, router.get(), 0);
+  bool new_extent;
+
+  // Scenario: pages without a hint are packed from the start of the file.
+  EXPECT_EQ(0, allocator.Allocate(INVALID_PAGE_ID, &new_extent));
+  EXPECT_TRUE(new_extent);
+  EXPECT_EQ(1, allocator.Allocate(INVALID_PAGE_ID, &new_extent));
+  EXPECT_FALSE(new_extent);
+  EXPECT_EQ(2, allocator.Allocate(INVALID_PAGE_ID, &new_extent));
+
+  // Scenario: a freed page is handed out again, freeing it twice changes nothing.
+  allocator.Free(1);
+  allocator.Free(1);
+  EXPECT_FALSE(map.IsAllocated(1));
+  EXPECT_EQ(1, allocator.Allocate(INVALID_PAGE_ID, &new_extent));
+  EXPECT_EQ(3, allocator.Allocate(INVALID_PAGE_ID, &new_extent));
+
+  // Scenario: a page with a hint goes next to the hint while its extent has room, then into an empty extent.
+  EXPECT_EQ(4, allocator.Allocate(2, &new_extent));
+  for (page_id_t page_id = 5; page_id < EXTENT_SIZE; page_id++) {
+    EXPECT_EQ(page_id, allocator.Allocate(page_id - 1, &new_extent));
+  }
+  EXPECT_EQ(EXTENT_SIZE, allocator.Allocate(EXTENT_SIZE - 1, &new_extent));
+  EXPECT_TRUE(new_extent);
+  EXPECT_EQ(EXTENT_SIZE + 1, allocator.Allocate(EXTENT_SIZE, &new_extent));
+  EXPECT_FALSE(new_extent);
+
+  page_id_t first_page_id;
+  page_id_t end_page_id;
+  allocator.GetExtentRange(EXTENT_SIZE + 1, &first_page_id, &end_page_id);
+  EXPECT_EQ(EXTENT_SIZE, first_page_id);
+  EXPECT_EQ(2 * EXTENT_SIZE, end_page_id);
+
+  // Scenario: a new allocator picks up where the map left off.
+  ExtentAllocator reopened(&map, router.get(), 0);
+  EXPECT_EQ(EXTENT_SIZE + 2, reopened.Allocate(INVALID_PAGE_ID, &new_extent));
+}
+
+// NOLINTNEXTLINE
+TEST(ExtentAllocatorTest, InstanceTest) {
+  FreeSpaceMap map;
+  auto router = PageRouter::Create(RoutingType::EXTENT, 2);
+  ExtentAllocator allocator0(&map, router.get(), 0);
+  ExtentAllocator allocator1(&map, router.get(), 1);
+  bool new_extent;
+
+  // Scenario: every instance allocates its own pages, and a hint in another instance is ignored.
+  EXPECT_EQ(0, allocator0.Allocate(INVALID_PAGE_ID, &new_extent));
+  EXPECT_EQ(EXTENT_SIZE, allocator1.Allocate(INVALID_PAGE_ID, &new_extent));
+  EXPECT_EQ(EXTENT_SIZE + 1, allocator1.Allocate(0, &new_extent));
+  EXPECT_EQ(3, map.GetNumAllocated());
+
+  page_id_t first_page_id;
+  page_id_t end_page_id;
+  allocator1.GetExtentRange(EXTENT_SIZE, &first_page_id, &end_page_id);
+  EXPECT_EQ(EXTENT_SIZE, first_page_id);
+  EXPECT_EQ(2 * EXTENT_SIZE, end_page_id);
+}
+
+// NOLINTNEXTLINE
+TEST(ExtentAllocatorTest, ReuseAfterDeleteTest) {
+  const std::string db_name = "test_extent_allocator.db";
+  const std::string fsm_name = "test_extent_allocator.fsm";
+  remove(db_name.c_str());
+  remove(fsm_name.c_str());
+  const size_t num_pages = 2 * EXTENT_SIZE;
+  page_id_t page_id;
+
+  {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+    for (size_t i = 0; i < num_pages; i++) {
+      Page *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(static_cast<page_id_t>(i), page_id);
+      snprintf(page->GetData(), PAGE_SIZE, "page %zu", i);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    bpm->FlushAllPages();
+    const auto file_size = std::filesystem::file_size(db_name);
+
+    // Scenario: a pinned page cannot be deleted and keeps its id.
+    ASSERT_NE(nullptr, bpm->FetchPage(5));
+    EXPECT_FALSE(bpm->DeletePage(5));
+    EXPECT_TRUE(disk_manager->GetFreeSpaceMap()->IsAllocated(5));
+    EXPECT_TRUE(bpm->UnpinPage(5, false));
+
+    // Scenario: deleted pages are reused, so churn does not grow the file, and read back as zeros.
+    for (int round = 0; round < 10; round++) {
+      EXPECT_TRUE(bpm->DeletePage(5));
+      EXPECT_TRUE(bpm->DeletePage(7));
+      EXPECT_FALSE(disk_manager->GetFreeSpaceMap()->IsAllocated(5));
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      EXPECT_EQ(5, page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      EXPECT_EQ(7, page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    bpm->FlushAllPages();
+    EXPECT_EQ(file_size, std::filesystem::file_size(db_name));
+    char data[PAGE_SIZE];
+    char zeros[PAGE_SIZE] = {0};
+    disk_manager->ReadPage(8, data);
+    EXPECT_STREQ("page 8", data);
+    EXPECT_TRUE(bpm->DeletePage(8));
+    disk_manager->ReadPage(8, data);
+    EXPECT_EQ(0, memcmp(data, zeros, PAGE_SIZE));
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(8, page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+    // Scenario: a page created near another one goes into its extent.
+    EXPECT_TRUE(bpm->DeletePage(EXTENT_SIZE + 3));
+    ASSERT_NE(nullptr, bpm->NewPageNear(EXTENT_SIZE, &page_id));
+    EXPECT_EQ(EXTENT_SIZE + 3, page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    EXPECT_TRUE(bpm->DeletePage(9));
+    delete bpm;
+    disk_manager->ShutDown();
+    delete disk_manager;
+  }
+
+  // Scenario: the free space map survives a restart.
+  {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+    EXPECT_FALSE(disk_manager->GetFreeSpaceMap()->IsAllocated(9));
+    EXPECT_EQ(num_pages - 1, disk_manager->GetFreeSpaceMap()->GetNumAllocated());
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(9, page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(static_cast<page_id_t>(num_pages), page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    delete bpm;
+    disk_manager->ShutDown();
+    delete disk_manager;
+  }
+
+  // Scenario: a database file without its map is taken to be fully allocated, up to the preallocated third extent.
+  remove(fsm_name.c_str());
+  {
+    auto *disk_manager = new DiskManager(db_name);
+    EXPECT_EQ(3 * EXTENT_SIZE, disk_manager->GetFreeSpaceMap()->GetNumAllocated());
+    disk_manager->ShutDown();
+    delete disk_manager;
+  }
+  remove(db_name.c_str());
+  remove(fsm_name.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(ExtentAllocatorTest, CrashRestartTest) {
+  const std::string db_name = "test_extent_allocator.db";
+  const std::string fsm_name = "test_extent_allocator.fsm";
+  const std::string log_name = "test_extent_allocator.log";
+  remove(db_name.c_str());
+  remove(fsm_name.c_str());
+  page_id_t page_id;
+
+  // A clean run leaves pages 0 and 2 allocated and 1 free.
+  {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+    for (int i = 0; i < 3; i++) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    EXPECT_TRUE(bpm->DeletePage(1));
+    delete bpm;
+    disk_manager->ShutDown();
+    delete disk_manager;
+  }
+
+  // Scenario: a run that allocates pages 1 and 3 and crashes before it is shut down.
+  auto *crashed_disk_manager = new DiskManager(db_name);
+  auto *crashed_bpm = new BufferPoolManagerInstance(10, crashed_disk_manager);
+  std::vector<page_id_t> page_ids{0, 2};
+  for (int i = 0; i < 2; i++) {
+    ASSERT_NE(nullptr, crashed_bpm->NewPage(&page_id));
+    EXPECT_TRUE(crashed_bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  crashed_bpm->FlushAllPages();
+
+  // The restart does not find a map and hands out none of the pages the crashed run had allocated.
+  {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+    for (auto allocated_page_id : page_ids) {
+      EXPECT_TRUE(disk_manager->GetFreeSpaceMap()->IsAllocated(allocated_page_id));
+    }
+    for (int i = 0; i < 3; i++) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      EXPECT_EQ(page_ids.end(), std::find(page_ids.begin(), page_ids.end(), page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+    delete bpm;
+    disk_manager->ShutDown();
+    delete disk_manager;
+  }
+
+  delete crashed_bpm;
+  delete crashed_disk_manager;
+  remove(db_name.c_str());
+  remove(fsm_name.c_str());
+  remove(log_name.c_str());
+}
+
+}  // namespace bustub
@@ -0,0 +1,45 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+TEST(FrameArenaTest, SampleTest) {
+  const size_t num_frames = 1024;
+  FrameArena arena(num_frames, sizeof(Page), 0);
+
+  // Scenario: the data area starts on a huge page boundary and the descriptors on a cache line.
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetFrameData(0)) % (2 * 1024 * 1024));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(arena.GetDescriptors()) % 64);
+  EXPECT_EQ(0, sizeof(Page) % 64);
+  EXPECT_EQ(arena.GetFrameData(0) + PAGE_SIZE, arena.GetFrameData(1));
+
+  // Scenario: every frame can be written, and released frames read as zeros again.
+  for (size_t i = 0; i < num_frames; ++i) {
+    memset(arena.GetFrameData(i), 'x', PAGE_SIZE);
+  }
+  arena.Release(num_frames / 2, num_frames);
+  EXPECT_EQ('x', arena.GetFrameData(num_frames / 2 - 1)[PAGE_SIZE - 1]);
+  EXPECT_EQ(0, arena.GetFrameData(num_frames / 2)[0]);
+  EXPECT_EQ(0, arena.GetFrameData(num_frames - 1)[PAGE_SIZE - 1]);
+
+  EXPECT_GE(FrameArena::NumNumaNodes(), 1);
+}
+
+}  // namespace bustub
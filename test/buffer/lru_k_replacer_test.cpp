@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: access frames 1-6 once, and frame 1 a second time. Only frame 1 has a finite backward 2-distance.
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_k_replacer.Pin(frame_id);
+    lru_k_replacer.Unpin(frame_id);
+  }
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with a single access go first, in order of that access.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: pin 5 and access 6 again. Now 1 and 6 both have two accesses and 1's second-to-last is older.
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.Pin(6);
+  lru_k_replacer.Unpin(6);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: 5 becomes evictable again.
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(7, 2, 4);
+
+  // Scenario: frame 1 is pinned three times in a row (correlated), frame 2 twice far apart (uncorrelated).
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+  for (int i = 0; i < 3; i++) {
+    lru_k_replacer.Pin(1);
+    lru_k_replacer.Unpin(1);
+  }
+  for (frame_id_t frame_id = 3; frame_id <= 6; frame_id++) {
+    lru_k_replacer.Pin(frame_id);
+  }
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+
+  // Frame 1 only counts as referenced once, so it is evicted before frame 2.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+}
+
+TEST(LRUKReplacerTest, EvictionOrderTest) {
+  const size_t num_frames = 1000;
+  LRUKReplacer lru_k_replacer(num_frames, 2);
+
+  // Scenario: random accesses, with a random half of the frames left pinned for a while.
+  std::default_random_engine rng(15445);
+  std::uniform_int_distribution<frame_id_t> frame_dist(0, num_frames - 1);
+  for (int i = 0; i < 5000; i++) {
+    auto frame_id = frame_dist(rng);
+    lru_k_replacer.Pin(frame_id);
+    if (i % 2 == 0) {
+      lru_k_replacer.Unpin(frame_id);
+    }
+  }
+  for (frame_id_t frame_id = 0; frame_id < static_cast<frame_id_t>(num_frames); frame_id += 3) {
+    lru_k_replacer.Remove(frame_id);
+  }
+
+  // Victim takes the frames in the order GetEvictionOrder lists them, looking at one frame per victim.
+  std::vector<frame_id_t> order;
+  lru_k_replacer.GetEvictionOrder(&order);
+  EXPECT_EQ(order.size(), lru_k_replacer.Size());
+  auto steps = lru_k_replacer.GetVictimSearchSteps();
+  for (auto expected : order) {
+    frame_id_t frame_id;
+    ASSERT_TRUE(lru_k_replacer.Victim(&frame_id));
+    EXPECT_EQ(expected, frame_id);
+  }
+  EXPECT_EQ(order.size(), lru_k_replacer.GetVictimSearchSteps() - steps);
+  frame_id_t frame_id;
+  EXPECT_FALSE(lru_k_replacer.Victim(&frame_id));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+/**
+ * Replays a page access trace against a simulated pool of num_frames frames managed by replacer.
+ * @return the number of accesses that hit a resident page
+ */
+static auto ReplayTrace(Replacer *replacer, size_t num_frames, const std::vector<page_id_t> &trace) -> size_t {
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frames(num_frames, INVALID_PAGE_ID);
+  size_t next_free_frame = 0;
+  size_t hits = 0;
+  for (auto page_id : trace) {
+    frame_id_t frame_id;
+    auto itr = page_table.find(page_id);
+    if (itr != page_table.end()) {
+      hits++;
+      frame_id = itr->second;
+    } else {
+      if (next_free_frame < num_frames) {
+        frame_id = static_cast<frame_id_t>(next_free_frame++);
+      } else {
+        EXPECT_TRUE(replacer->Victim(&frame_id));
+        page_table.erase(frames[frame_id]);
+      }
+      frames[frame_id] = page_id;
+      page_table[page_id] = frame_id;
+    }
+    replacer->Pin(frame_id);
+    replacer->Unpin(frame_id);
+  }
+  return hits;
+}
+
+TEST(LRUKReplacerTest, HitRatioTest) {
+  const size_t num_frames = 64;
+  const page_id_t num_hot_pages = 40;
+  const page_id_t num_scan_pages = 1000;
+  const int tuples_per_page = 4;
+
+  // Point lookups on a small hot set (index and hot-row pages), interrupted every 2000 lookups by a full sequential
+  // scan of a large table that pins each heap page once per tuple.
+  std::default_random_engine rng(15445);
+  std::uniform_int_distribution<page_id_t> hot_dist(0, num_hot_pages - 1);
+  std::vector<page_id_t> trace;
+  for (int round = 0; round < 5; round++) {
+    for (int i = 0; i < 2000; i++) {
+      trace.emplace_back(hot_dist(rng));
+    }
+    for (page_id_t page_id = num_hot_pages; page_id < num_hot_pages + num_scan_pages; page_id++) {
+      for (int i = 0; i < tuples_per_page; i++) {
+        trace.emplace_back(page_id);
+      }
+    }
+  }
+
+  LRUReplacer lru_replacer(num_frames);
+  LRUKReplacer lru_k_replacer(num_frames, LRUK_REPLACER_K, LRUK_CORRELATED_PERIOD);
+  auto lru_hits = ReplayTrace(&lru_replacer, num_frames, trace);
+  auto lru_k_hits = ReplayTrace(&lru_k_replacer, num_frames, trace);
+
+  // The repeated accesses to a scanned page are hits for both policies, but only LRU-K keeps the hot set resident
+  // across scans: each scan costs LRU all of the hot pages again.
+  EXPECT_GT(lru_k_hits, lru_hits);
+  size_t num_hot_accesses = 5 * 2000;
+  size_t num_scan_rehits = 5 * num_scan_pages * (tuples_per_page - 1);
+  EXPECT_GE(lru_k_hits - num_scan_rehits, num_hot_accesses - num_hot_pages);
+  EXPECT_LE(lru_hits - num_scan_rehits, num_hot_accesses - 5 * num_hot_pages);
+}
+
+}  // namespace bustub
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// memory_pressure_controller_test.cpp
+//
+// Identification: test/buffer/memory_pressure_controller_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/memory_pressure_controller.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MemoryPressureControllerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t chunk = BUFFER_POOL_CHUNK_SIZE;
+  const size_t chunk_bytes = chunk * PAGE_SIZE;
+  const size_t low_watermark = 4 * chunk_bytes;
+  const size_t high_watermark = 8 * chunk_bytes;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(2 * chunk, disk_manager, nullptr, ReplacerType::LRU, 4 * chunk);
+  std::atomic<size_t> available{high_watermark};
+  auto *controller = new MemoryPressureController(bpm, chunk, 3 * chunk, low_watermark, high_watermark,
+                                                  [&available] { return available.load(); });
+
+  // Scenario: between the watermarks the pool keeps its size.
+  EXPECT_EQ(2 * chunk, controller->Adjust());
+  available = high_watermark + chunk_bytes - 1;
+  EXPECT_EQ(2 * chunk, controller->Adjust());
+
+  // Scenario: with memory to spare the pool grows a chunk at a time, up to its maximum.
+  available = high_watermark + 4 * chunk_bytes;
+  EXPECT_EQ(3 * chunk, controller->Adjust());
+  EXPECT_EQ(3 * chunk, controller->Adjust());
+  EXPECT_EQ(3 * chunk, bpm->GetPoolSize());
+
+  // Scenario: under pressure the pool gives back the missing memory at once, down to its minimum.
+  available = low_watermark - chunk_bytes - 1;
+  EXPECT_EQ(chunk, controller->Adjust());
+  available = 0;
+  EXPECT_EQ(chunk, controller->Adjust());
+  EXPECT_EQ(chunk, bpm->GetPoolSize());
+
+  EXPECT_GT(MemoryPressureController::ReadAvailableMemory(), 0);
+
+  delete controller;
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_router_test.cpp
+//
+// Identification: test/buffer/page_router_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_router.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageRouterTest, ModuloTest) {
+  auto router = PageRouter::Create(RoutingType::MODULO, 3);
+  EXPECT_EQ(0, router->GetInstance(0));
+  EXPECT_EQ(1, router->GetInstance(1));
+  EXPECT_EQ(0, router->GetInstance(3));
+  EXPECT_EQ(2, router->GetLocalIndex(7));
+  EXPECT_EQ(7, router->GetPageId(1, 2));
+}
+
+// NOLINTNEXTLINE
+TEST(PageRouterTest, ExtentTest) {
+  const uint32_t num_instances = 3;
+  auto router = PageRouter::Create(RoutingType::EXTENT, num_instances);
+
+  // Scenario: an extent stays on one instance, the next one goes to the next instance.
+  for (page_id_t page_id = 0; page_id < EXTENT_SIZE; page_id++) {
+    EXPECT_EQ(0, router->GetInstance(page_id));
+    EXPECT_EQ(1, router->GetInstance(EXTENT_SIZE + page_id));
+    EXPECT_EQ(0, router->GetInstance(num_instances * EXTENT_SIZE + page_id));
+  }
+
+  // Scenario: the pages an instance allocates in a row are consecutive within an extent.
+  EXPECT_EQ(EXTENT_SIZE, router->GetPageId(1, 0));
+  EXPECT_EQ(EXTENT_SIZE + 1, router->GetPageId(1, 1));
+  EXPECT_EQ(4 * EXTENT_SIZE, router->GetPageId(1, EXTENT_SIZE));
+}
+
+// NOLINTNEXTLINE
+TEST(PageRouterTest, BijectionTest) {
+  for (auto routing_type : {RoutingType::MODULO, RoutingType::EXTENT}) {
+    for (uint32_t num_instances = 1; num_instances <= 5; num_instances++) {
+      auto router = PageRouter::Create(routing_type, num_instances);
+      for (page_id_t page_id = 0; page_id < 10 * EXTENT_SIZE; page_id++) {
+        uint32_t instance_index = router->GetInstance(page_id);
+        ASSERT_LT(instance_index, num_instances);
+        EXPECT_EQ(page_id, router->GetPageId(instance_index, router->GetLocalIndex(page_id)));
+      }
+    }
+  }
+}
+
+}  // namespace bustub
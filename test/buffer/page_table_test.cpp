@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(8);
+
+  // Scenario: look up pages in an empty table.
+  EXPECT_EQ(-1, page_table.Find(0));
+  EXPECT_EQ(-1, page_table.Find(7));
+
+  // Scenario: fill the table to its capacity and find every page.
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    page_table.Insert(page_id * 3, page_id);
+  }
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    EXPECT_EQ(page_id, page_table.Find(page_id * 3));
+  }
+  EXPECT_EQ(-1, page_table.Find(1));
+
+  // Scenario: erase every other page; the rest must still be found.
+  for (page_id_t page_id = 0; page_id < 8; page_id += 2) {
+    page_table.Erase(page_id * 3);
+  }
+  page_table.Erase(1);
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    EXPECT_EQ(page_id % 2 == 0 ? -1 : page_id, page_table.Find(page_id * 3));
+  }
+
+  // Scenario: reuse the freed slots.
+  for (page_id_t page_id = 0; page_id < 8; page_id += 2) {
+    page_table.Insert(page_id * 3 + 100, page_id);
+  }
+  for (page_id_t page_id = 0; page_id < 8; ++page_id) {
+    EXPECT_EQ(page_id, page_table.Find(page_id % 2 == 0 ? page_id * 3 + 100 : page_id * 3));
+  }
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  const size_t num_frames = 64;
+  const int num_readers = 4;
+  PageTable page_table(num_frames);
+
+  // The writer keeps remapping pages; page p always lives in frame p % num_frames, so a reader can tell a wrong
+  // result from a (tolerated) miss.
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; ++tid) {
+    readers.emplace_back([&page_table, &done] {
+      while (!done) {
+        for (page_id_t page_id = 0; page_id < 4 * static_cast<page_id_t>(num_frames); ++page_id) {
+          auto frame_id = page_table.Find(page_id);
+          EXPECT_TRUE(frame_id == -1 || frame_id == page_id % static_cast<page_id_t>(num_frames));
+        }
+      }
+    });
+  }
+
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_frames); ++page_id) {
+    page_table.Insert(page_id, page_id);
+  }
+  for (int round = 1; round < 200; ++round) {
+    for (page_id_t frame_id = 0; frame_id < static_cast<page_id_t>(num_frames); ++frame_id) {
+      page_table.Erase(frame_id + (round - 1) % 4 * static_cast<page_id_t>(num_frames));
+      page_table.Insert(frame_id + round % 4 * static_cast<page_id_t>(num_frames), frame_id);
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  // Every page of the last round is still found once the writer is done.
+  for (page_id_t frame_id = 0; frame_id < static_cast<page_id_t>(num_frames); ++frame_id) {
+    EXPECT_EQ(frame_id, page_table.Find(frame_id + 199 % 4 * static_cast<page_id_t>(num_frames)));
+  }
+}
+
+}  // namespace bustub
@@ -11,10 +11,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/parallel_buffer_pool_manager.h"
+#include <algorithm>
 #include <cstdio>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats_reporter.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -79,11 +84,10 @@ TEST(ParallelBufferPoolManagerTest, BinaryDataTest) {
   EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
   EXPECT_EQ(true, bpm->UnpinPage(0, true));
 
+  delete bpm;
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
-
-  delete bpm;
   delete disk_manager;
 }
 
@@ -143,11 +147,181 @@ TEST(ParallelBufferPoolManagerTest, SampleTest) {
   EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
   EXPECT_EQ(nullptr, bpm->FetchPage(4));
 
+  delete bpm;
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, BatchFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: a batch spanning every instance returns the pages in the order they were asked for.
+  std::reverse(page_ids.begin(), page_ids.end());
+  std::vector<Page *> pages;
+  bpm->FetchPages(page_ids, &pages);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  char expected[PAGE_SIZE];
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    snprintf(expected, PAGE_SIZE, "page %d", page_ids[i]);
+    EXPECT_EQ(0, strcmp(pages[i]->GetData(), expected));
+  }
+  EXPECT_TRUE(bpm->UnpinPages(page_ids, false));
+  EXPECT_FALSE(bpm->UnpinPages(page_ids, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU,
+                                            4 * buffer_pool_size);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: the instances share the new size; none of them can exceed its maximum or drop below one frame.
+  EXPECT_EQ(10, bpm->ResizePool(10));
+  EXPECT_EQ(10, bpm->GetPoolSize());
+  EXPECT_EQ(num_instances * 4 * buffer_pool_size, bpm->ResizePool(100));
+  EXPECT_EQ(num_instances, bpm->ResizePool(0));
+
+  // Scenario: every instance can still hold a page.
+  for (size_t i = 0; i < num_instances; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
 
   delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, StatsTest) {
+  const size_t num_instances = 2;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new ParallelBufferPoolManager(num_instances, 4, disk_manager);
+
+  // a thread creates its pages in its home instance, so all three land on instance 0
+  page_id_t page_ids[3];
+  for (auto &page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  for (auto page_id : page_ids) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: the snapshot breaks the counters down by instance, which shows the skew.
+  std::vector<BufferPoolStats> instance_stats;
+  BufferPoolStats stats = bpm->GetStats(&instance_stats);
+  ASSERT_EQ(num_instances, instance_stats.size());
+  EXPECT_EQ(0, instance_stats[0].instance_index_);
+  EXPECT_EQ(1, instance_stats[1].instance_index_);
+  EXPECT_EQ(3, instance_stats[0].hits_);
+  EXPECT_EQ(0, instance_stats[1].hits_);
+  EXPECT_EQ(3, stats.hits_);
+  EXPECT_EQ(8, stats.pool_size_);
+
+  // Scenario: the reporter hands the same breakdown to its callback.
+  std::vector<BufferPoolStats> reported;
+  {
+    BufferPoolStatsReporter reporter(bpm, [&reported](const std::vector<BufferPoolStats> &stats) { reported = stats; });
+    reporter.Report();
+  }
+  ASSERT_EQ(num_instances, reported.size());
+  EXPECT_EQ(3, reported[0].hits_);
+  BufferPoolStatsReporter::LogStats(reported);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ExtentRoutingTest) {
+  const size_t num_instances = 4;
+  const size_t num_threads = 4;
+  const int pages_per_thread = 2 * EXTENT_SIZE;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new ParallelBufferPoolManager(num_instances, 2 * EXTENT_SIZE, disk_manager, nullptr, ReplacerType::LRU,
+                                            0, RoutingType::EXTENT);
+
+  // Scenario: a thread fills a whole extent of its home instance before it moves on to the next instance.
+  std::vector<std::vector<page_id_t>> thread_page_ids(num_threads + 1);
+  for (page_id_t i = 0; i < pages_per_thread; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(i, page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    thread_page_ids[num_threads].push_back(page_id);
+  }
+
+  // Scenario: threads creating pages concurrently are handed distinct page ids.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([bpm, &page_ids = thread_page_ids[t]] {
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        auto *page = bpm->NewPage(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+        page_ids.push_back(page_id);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::set<page_id_t> all_page_ids;
+  for (auto &page_ids : thread_page_ids) {
+    all_page_ids.insert(page_ids.begin(), page_ids.end());
+  }
+  EXPECT_EQ((num_threads + 1) * pages_per_thread, all_page_ids.size());
+
+  // Scenario: the pages are found in the instance that created them.
+  for (auto page_id : thread_page_ids[0]) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
   delete disk_manager;
 }
 
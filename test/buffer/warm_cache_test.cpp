@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// warm_cache_test.cpp
+//
+// Identification: test/buffer/warm_cache_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/warm_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(WarmCacheTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const std::string warm_cache_name = "test.warm";
+  remove(warm_cache_name.c_str());
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+  auto *warm_cache = new WarmCache(bpm, warm_cache_name);
+  // Scenario: without a file there is nothing to load.
+  EXPECT_EQ(0, warm_cache->WaitForLoad());
+
+  page_id_t page_id;
+  for (int i = 0; i < 5; ++i) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  for (page_id_t hot : {3, 4}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(hot));
+    bpm->UnpinPage(hot, false);
+  }
+
+  // Scenario: the file lists the resident pages, most recently used first.
+  EXPECT_TRUE(warm_cache->Dump());
+  std::vector<page_id_t> page_ids;
+  EXPECT_TRUE(WarmCache::ReadFile(warm_cache_name, &page_ids));
+  EXPECT_EQ(std::vector<page_id_t>({4, 3, 2, 1, 0}), page_ids);
+  EXPECT_FALSE(WarmCache::ReadFile(db_name, &page_ids));
+
+  delete warm_cache;
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Scenario: a restarted pool reads back the hottest pages that fit.
+  bpm = new BufferPoolManagerInstance(3, disk_manager);
+  warm_cache = new WarmCache(bpm, warm_cache_name);
+  EXPECT_EQ(3, warm_cache->WaitForLoad());
+  bpm->GetResidentPages(&page_ids);
+  std::sort(page_ids.begin(), page_ids.end());
+  EXPECT_EQ(std::vector<page_id_t>({2, 3, 4}), page_ids);
+  Page *page = bpm->FetchPage(3);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 3"));
+  bpm->UnpinPage(3, false);
+  delete warm_cache;
+  delete bpm;
+
+  // Scenario: the loader only fills free frames and leaves pinned pages alone.
+  bpm = new BufferPoolManagerInstance(4, disk_manager);
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  warm_cache = new WarmCache(bpm, warm_cache_name);
+  EXPECT_EQ(2, warm_cache->WaitForLoad());
+  bpm->GetResidentPages(&page_ids);
+  EXPECT_EQ(4, page_ids.size());
+  std::sort(page_ids.begin(), page_ids.end());
+  EXPECT_EQ(0, page_ids[0]);
+  EXPECT_EQ(1, page_ids[1]);
+  bpm->UnpinPage(0, false);
+  bpm->UnpinPage(1, false);
+  delete warm_cache;
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove(warm_cache_name.c_str());
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_test.cpp
+//
+// Identification: test/common/crc32c_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c.h"
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "common/config.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, KnownValuesTest) {
+  const char *check = "123456789";
+  EXPECT_EQ(0xE3069283, Crc32c::Compute(check, strlen(check)));
+  EXPECT_EQ(0xE3069283, Crc32c::ComputeWithTable(check, strlen(check)));
+  EXPECT_EQ(0, Crc32c::Compute(check, 0));
+
+  // RFC 3720, B.4: 32 bytes of zeros
+  std::vector<char> zeros(32, 0);
+  EXPECT_EQ(0x8A9136AA, Crc32c::Compute(zeros.data(), zeros.size()));
+  EXPECT_EQ(0x8A9136AA, Crc32c::ComputeWithTable(zeros.data(), zeros.size()));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cTest, TableMatchesHardwareTest) {
+  std::mt19937 gen(42);
+  std::vector<char> data(3 * PAGE_SIZE + 7);
+  for (auto &c : data) {
+    c = static_cast<char>(gen());
+  }
+  // every length and alignment, including the odd bytes around the 8-byte words
+  for (size_t offset = 0; offset < 8; offset++) {
+    for (size_t size = 0; size < 64; size++) {
+      ASSERT_EQ(Crc32c::ComputeWithTable(data.data() + offset, size), Crc32c::Compute(data.data() + offset, size));
+    }
+  }
+  // long buffers are checksummed in interleaved blocks
+  for (size_t size = PAGE_SIZE - 32; size <= PAGE_SIZE; size++) {
+    ASSERT_EQ(Crc32c::ComputeWithTable(data.data() + 1, size), Crc32c::Compute(data.data() + 1, size));
+  }
+  uint32_t whole = Crc32c::Compute(data.data(), data.size());
+  EXPECT_EQ(whole, Crc32c::ComputeWithTable(data.data(), data.size()));
+
+  // Scenario: a buffer checksummed in pieces has the checksum of the whole.
+  uint32_t crc = Crc32c::Compute(data.data(), 1000);
+  EXPECT_EQ(whole, Crc32c::Compute(data.data() + 1000, data.size() - 1000, crc));
+  crc = Crc32c::ComputeWithTable(data.data(), 13);
+  EXPECT_EQ(whole, Crc32c::ComputeWithTable(data.data() + 13, data.size() - 13, crc));
+
+  // Scenario: a single flipped bit changes the checksum.
+  data[PAGE_SIZE / 2] ^= 0x10;
+  EXPECT_NE(whole, Crc32c::Compute(data.data(), data.size()));
+}
+
+// A benchmark rather than a test, run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST(Crc32cTest, DISABLED_ThroughputTest) {
+  const int num_pages = 4096;
+  std::vector<char> page(PAGE_SIZE, 'x');
+  for (bool table : {false, true}) {
+    uint32_t crc = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_pages; i++) {
+      crc = table ? Crc32c::ComputeWithTable(page.data(), PAGE_SIZE, crc)
+                  : Crc32c::Compute(page.data(), PAGE_SIZE, crc);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << (table ? "table" : (Crc32c::IsHardwareAccelerated() ? "sse4.2" : "default")) << ": "
+              << num_pages * static_cast<double>(PAGE_SIZE) / elapsed.count() / (1 << 20) << " MB/s (crc " << crc
+              << ")" << std::endl;
+  }
+}
+
+}  // namespace bustub
@@ -57,4 +57,15 @@ TEST(RWLatchTest, BasicTest) {
   }
   EXPECT_EQ(counter.Read(), 55);
 }
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, TryWLockTest) {
+  ReaderWriterLatch latch;
+  latch.RLock();
+  EXPECT_FALSE(latch.TryWLock());
+  latch.RUnlock();
+  EXPECT_TRUE(latch.TryWLock());
+  EXPECT_FALSE(latch.TryWLock());
+  latch.WUnlock();
+}
 }  // namespace bustub
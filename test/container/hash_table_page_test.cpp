@@ -52,8 +52,8 @@ TEST(HashTablePageTest, DirectoryPageSampleTest) {
   bpm->UnpinPage(directory_page_id, true, nullptr);
   disk_manager->ShutDown();
   remove("test.db");
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
 }
 
 // NOLINTNEXTLINE
@@ -110,8 +110,63 @@ TEST(HashTablePageTest, BucketPageSampleTest) {
   bpm->UnpinPage(bucket_page_id, true, nullptr);
   disk_manager->ShutDown();
   remove("test.db");
+  delete bpm;
   delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BucketPageProbeTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+  const int num_keys = 37;
+
+  // Scenario: a bucket filled with non-unique keys, across all groups of slots.
+  EXPECT_TRUE(bucket_page->IsEmpty());
+  int capacity = 0;
+  while (bucket_page->Insert(capacity % num_keys, capacity, IntComparator())) {
+    EXPECT_FALSE(bucket_page->Insert(capacity % num_keys, capacity, IntComparator()));
+    capacity++;
+  }
+  ASSERT_GT(capacity, 400);
+  EXPECT_TRUE(bucket_page->IsFull());
+  EXPECT_EQ(capacity, bucket_page->NumReadable());
+  EXPECT_FALSE(bucket_page->Insert(num_keys, capacity, IntComparator()));
+
+  // Scenario: removing every third pair leaves tombstones that lookups skip and inserts reuse.
+  for (int i = 0; i < capacity; i += 3) {
+    EXPECT_TRUE(bucket_page->Remove(i % num_keys, i, IntComparator()));
+  }
+  EXPECT_FALSE(bucket_page->IsFull());
+  EXPECT_EQ(capacity - (capacity + 2) / 3, bucket_page->NumReadable());
+  for (int key = 0; key < num_keys + 1; key++) {
+    std::vector<int> expected;
+    for (int i = key; i < capacity && key < num_keys; i += num_keys) {
+      if (i % 3 != 0) {
+        expected.push_back(i);
+      }
+    }
+    std::vector<int> result;
+    EXPECT_EQ(!expected.empty(), bucket_page->GetValue(key, IntComparator(), &result));
+    EXPECT_EQ(expected, result);
+  }
+  EXPECT_TRUE(bucket_page->Insert(num_keys, capacity, IntComparator()));
+  EXPECT_FALSE(bucket_page->IsReadable(3));
+  EXPECT_EQ(num_keys, bucket_page->KeyAt(0));
+
+  for (int i = 0; i < capacity; i++) {
+    bucket_page->RemoveAt(i);
+  }
+  EXPECT_TRUE(bucket_page->IsEmpty());
+  EXPECT_EQ(0, bucket_page->NumReadable());
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
   delete bpm;
+  delete disk_manager;
 }
 
 }  // namespace bustub
@@ -18,6 +18,8 @@
 #include "container/hash/extendible_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"  // NOLINT
 
 namespace bustub {
 
@@ -113,8 +115,352 @@ TEST(HashTableTest, SampleTest) {
 
   disk_manager->ShutDown();
   remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, SwizzleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  // far fewer frames than buckets, so buckets keep getting evicted and their references dropped
+  auto *bpm = new BufferPoolManagerInstance(4, disk_manager);
+  auto *ht = new ExtendibleHashTable<int, int, IntComparator>("blah", bpm, IntComparator(), HashFunction<int>(), true);
+
+  const int num_keys = 20000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht->Insert(nullptr, i, i));
+  }
+  EXPECT_GT(ht->GetGlobalDepth(), 4);
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < num_keys; i++) {
+      std::vector<int> res;
+      ASSERT_TRUE(ht->GetValue(nullptr, i, &res));
+      ASSERT_EQ(1, res.size());
+      EXPECT_EQ(i, res[0]);
+    }
+  }
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(ht->Remove(nullptr, i, i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 == 1, ht->GetValue(nullptr, i, &res));
+  }
+  ht->VerifyIntegrity();
+  delete ht;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentSplitTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *ht = new ExtendibleHashTable<int, int, IntComparator>("blah", bpm, IntComparator(), HashFunction<int>(), true);
+
+  // keys inserted up front must stay visible while other threads split their buckets
+  const int num_old_keys = 2000;
+  for (int i = 0; i < num_old_keys; i++) {
+    EXPECT_TRUE(ht->Insert(nullptr, i, i));
+  }
+
+  const int num_writers = 4;
+  const int num_keys_per_writer = 5000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_writers; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < num_keys_per_writer; i++) {
+        int key = num_old_keys + i * num_writers + t;
+        EXPECT_TRUE(ht->Insert(nullptr, key, key));
+      }
+    });
+  }
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&] {
+      for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < num_old_keys; i++) {
+          std::vector<int> res;
+          ASSERT_TRUE(ht->GetValue(nullptr, i, &res));
+          ASSERT_EQ(1, res.size());
+          EXPECT_EQ(i, res[0]);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  const int num_keys = num_old_keys + num_writers * num_keys_per_writer;
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht->GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+  ht->VerifyIntegrity();
+  delete ht;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, MultiPageDirectoryTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *ht = new ExtendibleHashTable<int, int, IntComparator>("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // Scenario: the index grows past the DIRECTORY_ARRAY_SIZE buckets a single directory page can point to.
+  const int num_keys = 240000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht->Insert(nullptr, i, i));
+  }
+  EXPECT_GT(ht->GetGlobalDepth(), 9);
+  ht->VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht->GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // Scenario: emptied buckets merge and the directory gives its pages back.
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht->Remove(nullptr, i, i));
+  }
+  EXPECT_LE(ht->GetGlobalDepth(), 9);
+  ht->VerifyIntegrity();
+  for (int i = 0; i < num_keys; i += 1000) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht->GetValue(nullptr, i, &res));
+  }
+  delete ht;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, MergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *ht = new ExtendibleHashTable<int, int, IntComparator>("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // Scenario: buckets that are mostly but not entirely emptied merge, and the directory shrinks with them.
+  const int num_keys = 20000;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht->Insert(nullptr, i, i));
+  }
+  uint32_t global_depth = ht->GetGlobalDepth();
+  for (int i = 0; i < num_keys; i++) {
+    if (i % 8 != 0) {
+      ASSERT_TRUE(ht->Remove(nullptr, i, i));
+    }
+  }
+  EXPECT_LT(ht->GetGlobalDepth(), global_depth);
+  ht->VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 8 == 0, ht->GetValue(nullptr, i, &res));
+  }
+
+  // Scenario: a sliding window of keys keeps the index at the same size, instead of growing it with every window.
+  for (int i = 0; i < num_keys; i += 8) {
+    ASSERT_TRUE(ht->Remove(nullptr, i, i));
+  }
+  const int window = 10000;
+  size_t num_pages = 0;
+  for (int round = 1; round <= 8; round++) {
+    for (int i = round * window; i < (round + 1) * window; i++) {
+      ASSERT_TRUE(ht->Insert(nullptr, i, i));
+    }
+    for (int i = (round - 1) * window; i < round * window && round > 1; i++) {
+      ASSERT_TRUE(ht->Remove(nullptr, i, i));
+    }
+    if (round == 2) {
+      num_pages = disk_manager->GetFreeSpaceMap()->GetNumAllocated();
+    }
+  }
+  EXPECT_LE(disk_manager->GetFreeSpaceMap()->GetNumAllocated(), num_pages + num_pages / 4);
+  ht->VerifyIntegrity();
+  delete ht;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto *ht = new ExtendibleHashTable<int, int, IntComparator>("blah", bpm, IntComparator(), HashFunction<int>(), true);
+
+  // keys inserted up front must stay visible while other threads split and merge the buckets around them
+  const int num_old_keys = 2000;
+  for (int i = 0; i < num_old_keys; i++) {
+    EXPECT_TRUE(ht->Insert(nullptr, i, i));
+  }
+
+  const int num_writers = 4;
+  const int num_keys_per_writer = 4000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_writers; t++) {
+    threads.emplace_back([&, t] {
+      for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < num_keys_per_writer; i++) {
+          int key = num_old_keys + i * num_writers + t;
+          EXPECT_TRUE(ht->Insert(nullptr, key, key));
+        }
+        for (int i = 0; i < num_keys_per_writer; i++) {
+          int key = num_old_keys + i * num_writers + t;
+          EXPECT_TRUE(ht->Remove(nullptr, key, key));
+        }
+      }
+    });
+  }
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&] {
+      for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < num_old_keys; i++) {
+          std::vector<int> res;
+          ASSERT_TRUE(ht->GetValue(nullptr, i, &res));
+          ASSERT_EQ(1, res.size());
+          EXPECT_EQ(i, res[0]);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  ht->VerifyIntegrity();
+  for (int i = 0; i < num_old_keys + num_writers * num_keys_per_writer; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i < num_old_keys, ht->GetValue(nullptr, i, &res));
+  }
+  delete ht;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, BulkLoadTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> inserted("inserted", bpm, IntComparator(), HashFunction<int>());
+  ExtendibleHashTable<int, int, IntComparator> loaded("loaded", bpm, IntComparator(), HashFunction<int>());
+
+  // Scenario: a bulk loaded table has the directory of one built by inserting the same entries one by one.
+  const int num_keys = 50000;
+  std::vector<std::pair<int, int>> entries;
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(inserted.Insert(nullptr, i, i));
+    entries.emplace_back(i, i);
+  }
+  EXPECT_TRUE(loaded.BulkLoad(nullptr, entries));
+  EXPECT_EQ(inserted.GetGlobalDepth(), loaded.GetGlobalDepth());
+  loaded.VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(loaded.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // Scenario: the loaded table takes inserts and removes as usual, and a second load inserts one by one.
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(loaded.Remove(nullptr, i, i));
+  }
+  EXPECT_TRUE(loaded.Insert(nullptr, num_keys, num_keys));
+  EXPECT_FALSE(loaded.BulkLoad(nullptr, {{1, 1}, {num_keys + 1, num_keys + 1}}));
+  for (int i = 0; i <= num_keys + 1; i++) {
+    std::vector<int> res;
+    EXPECT_EQ(i % 2 == 1 || i == num_keys, loaded.GetValue(nullptr, i, &res));
+  }
+  loaded.VerifyIntegrity();
+
+  // Scenario: a load large enough to need several directory pages.
+  ExtendibleHashTable<int, int, IntComparator> large("large", bpm, IntComparator(), HashFunction<int>());
+  entries.clear();
+  for (int i = 0; i < 6 * num_keys; i++) {
+    entries.emplace_back(i, i);
+  }
+  EXPECT_TRUE(large.BulkLoad(nullptr, entries));
+  EXPECT_GT(large.GetGlobalDepth(), 9);
+  large.VerifyIntegrity();
+  for (int i = 0; i < 6 * num_keys; i += 7) {
+    std::vector<int> res;
+    ASSERT_TRUE(large.GetValue(nullptr, i, &res));
+    EXPECT_EQ(i, res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete bpm;
   delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, DeepDirectoryTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema.get());
+  HashFunction<GenericKey<64>> hash_fn;
+  auto *ht = new ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>("blah", bpm, comparator, hash_fn);
+
+  // Scenario: one more key than a bucket holds, all alike in the low 18 bits of their hash, only a directory
+  // deeper than 18 can tell them apart. Its 2^18 slots take more directory pages than the root page can list.
+  using KeyType = GenericKey<64>;
+  using ValueType = RID;
+  const size_t num_keys = BUCKET_ARRAY_SIZE + 1;
+  const uint32_t mask = (1U << 18) - 1;
+  std::vector<GenericKey<64>> keys;
+  GenericKey<64> key;
+  for (int64_t i = 0; keys.size() < num_keys; i++) {
+    key.SetFromInteger(i);
+    if ((static_cast<uint32_t>(hash_fn.GetHash(key)) & mask) == 0) {
+      keys.push_back(key);
+    }
+  }
+  for (size_t i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht->Insert(nullptr, keys[i], RID(i)));
+  }
+  EXPECT_GT(ht->GetGlobalDepth(), 18);
+  ht->VerifyIntegrity();
+  for (size_t i = 0; i < num_keys; i++) {
+    std::vector<RID> res;
+    ASSERT_TRUE(ht->GetValue(nullptr, keys[i], &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(RID(i), res[0]);
+  }
+
+  // Scenario: emptied buckets merge and the directory gives its directory and segment pages back.
+  for (size_t i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht->Remove(nullptr, keys[i], RID(i)));
+  }
+  EXPECT_LE(ht->GetGlobalDepth(), 9);
+  ht->VerifyIntegrity();
+  delete ht;
+
+  disk_manager->ShutDown();
+  remove("test.db");
   delete bpm;
+  delete disk_manager;
 }
 
 }  // namespace bustub
@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io_test.cpp
+//
+// Identification: test/storage/async_io_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_io.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <future>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Write num_pages pages through an engine with all of them in flight, then read them back the same way. */
+void WriteAndReadBack(AsyncIoEngine *engine, int num_pages) {
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<std::vector<char>> buf(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<std::future<ssize_t>> results;
+  for (int is_write = 1; is_write >= 0; is_write--) {
+    results.clear();
+    for (int i = 0; i < num_pages; i++) {
+      std::memset(data[i].data(), i, PAGE_SIZE);
+      auto promise = std::make_shared<std::promise<ssize_t>>();
+      results.push_back(promise->get_future());
+      auto request = std::make_unique<DiskRequest>();
+      request->is_write_ = is_write == 1;
+      request->data_ = is_write == 1 ? data[i].data() : buf[i].data();
+      request->size_ = PAGE_SIZE;
+      request->offset_ = static_cast<off_t>(i) * PAGE_SIZE;
+      request->callback_ = [promise](ssize_t result) { promise->set_value(result); };
+      engine->Submit(std::move(request));
+    }
+    for (auto &result : results) {
+      EXPECT_EQ(PAGE_SIZE, result.get());
+    }
+  }
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_EQ(data[i], buf[i]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(AsyncIoTest, EngineTest) {
+  int fd = open("test.db", O_RDWR | O_CREAT | O_TRUNC, 0644);  // NOLINT
+  ASSERT_NE(-1, fd);
+
+  // Scenario: both engines run more requests than can be in flight at once.
+  for (bool use_io_uring : {false, true}) {
+    auto engine = AsyncIoEngine::Create(fd, use_io_uring);
+    if (!use_io_uring) {
+      EXPECT_FALSE(engine->IsIoUring());
+    }
+    WriteAndReadBack(engine.get(), 3 * ASYNC_IO_QUEUE_DEPTH);
+  }
+
+  // Scenario: a read past the end of the file is short, an invalid request fails.
+  auto engine = AsyncIoEngine::Create(fd);
+  std::vector<char> buf(PAGE_SIZE);
+  std::promise<ssize_t> past_end;
+  std::promise<ssize_t> invalid;
+  auto request = std::make_unique<DiskRequest>();
+  request->is_write_ = false;
+  request->data_ = buf.data();
+  request->size_ = PAGE_SIZE;
+  request->offset_ = static_cast<off_t>(1000) * PAGE_SIZE;
+  request->callback_ = [&past_end](ssize_t result) { past_end.set_value(result); };
+  engine->Submit(std::move(request));
+  EXPECT_EQ(0, past_end.get_future().get());
+  request = std::make_unique<DiskRequest>();
+  request->is_write_ = false;
+  request->data_ = buf.data();
+  request->size_ = PAGE_SIZE;
+  request->offset_ = -PAGE_SIZE;
+  request->callback_ = [&invalid](ssize_t result) { invalid.set_value(result); };
+  engine->Submit(std::move(request));
+  EXPECT_GT(0, invalid.get_future().get());
+
+  engine.reset();
+  close(fd);
+  remove("test.db");
+}
+
+}  // namespace bustub
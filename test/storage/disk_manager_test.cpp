@@ -10,7 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <cstring>
+#include <future>  // NOLINT
+#include <iostream>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -24,12 +30,16 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.crc");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.crc");
   };
 };
 
@@ -72,6 +82,270 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  // one byte off, so the buffers are never aligned for direct I/O
+  alignas(DiskManager::DIRECT_IO_ALIGNMENT) char buf[PAGE_SIZE + 1] = {0};
+  alignas(DiskManager::DIRECT_IO_ALIGNMENT) char data[PAGE_SIZE + 1] = {0};
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, true);
+  std::strncpy(data + 1, "A test string.", PAGE_SIZE);
+
+  // Scenario: unaligned buffers go through the bounce buffer, aligned ones are used as they are.
+  dm.WritePage(0, data + 1);
+  dm.ReadPage(0, buf + 1);
+  EXPECT_EQ(std::memcmp(buf + 1, data + 1, PAGE_SIZE), 0);
+  std::memset(buf, 0, sizeof(buf));
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data + 1, PAGE_SIZE), 0);
+
+  // Scenario: a page written past the end of the file can be read back, the gap reads as zeros.
+  dm.WritePage(3, data + 1);
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(std::memcmp(buf, data + 1, PAGE_SIZE), 0);
+  dm.ReadPage(2, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(2, dm.GetNumWrites());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWriteTest) {
+  const int num_threads = 4;
+  const int pages_per_thread = 100;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: threads write and read back their own pages at the same time.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&dm, t] {
+      char buf[PAGE_SIZE];
+      char data[PAGE_SIZE];
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id = i * num_threads + t;
+        std::memset(data, page_id, PAGE_SIZE);
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::memcmp(buf, data, PAGE_SIZE), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread, dm.GetNumWrites());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::vector<std::vector<char>> data(6, std::vector<char>(PAGE_SIZE));
+  for (size_t i = 0; i < data.size(); i++) {
+    std::memset(data[i].data(), static_cast<int>(i + 1), PAGE_SIZE);
+  }
+
+  // Scenario: pages given out of order are written as runs of adjacent pages: {2, 3, 4} and {7}. The second write of
+  // page 3 wins.
+  std::vector<page_id_t> page_ids{4, 7, 3, 2, 3};
+  std::vector<const char *> page_data;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    page_data.push_back(data[i].data());
+  }
+  EXPECT_TRUE(dm.WritePages(page_ids, page_data));
+  EXPECT_EQ(4, dm.GetNumWrites());
+  EXPECT_EQ(2, dm.GetNumVectoredWrites());
+
+  std::vector<char> buf(PAGE_SIZE);
+  std::vector<std::pair<page_id_t, size_t>> expected{{2, 3}, {3, 4}, {4, 0}, {7, 1}};
+  for (const auto &[page_id, i] : expected) {
+    dm.ReadPage(page_id, buf.data());
+    EXPECT_EQ(data[i], buf);
+  }
+  dm.ReadPage(5, buf.data());
+  EXPECT_EQ(0, buf[0]);
+
+  // Scenario: an empty batch writes nothing.
+  EXPECT_TRUE(dm.WritePages({}, {}));
+  EXPECT_EQ(2, dm.GetNumVectoredWrites());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AsyncReadWriteTest) {
+  const int num_pages = 200;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<std::vector<char>> buf(num_pages, std::vector<char>(PAGE_SIZE));
+
+  // Scenario: one thread keeps all the writes in flight, then all the reads.
+  std::vector<std::future<bool>> writes;
+  for (int i = 0; i < num_pages; i++) {
+    std::memset(data[i].data(), i, PAGE_SIZE);
+    writes.push_back(dm.WritePageAsync(i, data[i].data()));
+  }
+  for (auto &write : writes) {
+    EXPECT_TRUE(write.get());
+  }
+  std::vector<std::future<bool>> reads;
+  for (int i = 0; i < num_pages; i++) {
+    reads.push_back(dm.ReadPageAsync(i, buf[i].data()));
+  }
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_TRUE(reads[i].get());
+    EXPECT_EQ(data[i], buf[i]);
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  // Scenario: reading past the end of the file fails, synchronous reads see the asynchronous writes.
+  EXPECT_FALSE(dm.ReadPageAsync(num_pages + 1, buf[0].data()).get());
+  std::vector<char> page(PAGE_SIZE);
+  dm.ReadPage(num_pages - 1, page.data());
+  EXPECT_EQ(data[num_pages - 1], page);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  const page_id_t num_pages = 8;
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<char> page(PAGE_SIZE);
+  {
+    DiskManager dm("test.db", false, true);
+    ASSERT_TRUE(dm.IsChecksummed());
+    for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+      snprintf(data[page_id].data(), PAGE_SIZE, "page %d", page_id);
+    }
+    for (page_id_t page_id = 0; page_id < num_pages / 2; page_id++) {
+      dm.WritePage(page_id, data[page_id].data());
+    }
+    EXPECT_TRUE(dm.WritePages({4, 5}, {data[4].data(), data[5].data()}));
+    EXPECT_TRUE(dm.WritePageAsync(6, data[6].data()).get());
+    dm.WritePage(7, data[7].data());
+    dm.DeallocatePage(7);
+
+    // Scenario: intact pages pass, whichever way they were written.
+    for (page_id_t page_id = 0; page_id < num_pages - 1; page_id++) {
+      dm.ReadPage(page_id, page.data());
+      EXPECT_EQ(data[page_id], page);
+    }
+    EXPECT_TRUE(dm.ReadPageAsync(6, page.data()).get());
+    dm.ReadPage(7, page.data());
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    dm.ShutDown();
+  }
+
+  // Scenario: a bit flipped behind the disk manager's back is caught after a restart.
+  FILE *file = fopen("test.db", "r+b");
+  ASSERT_NE(nullptr, file);
+  ASSERT_EQ(0, fseek(file, 2 * PAGE_SIZE + 100, SEEK_SET));
+  ASSERT_EQ(1, fwrite("x", 1, 1, file));
+  fclose(file);
+  {
+    DiskManager dm("test.db", false, true);
+    EXPECT_TRUE(dm.ReadPage(1, page.data()));
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    EXPECT_FALSE(dm.ReadPage(2, page.data()));
+    EXPECT_EQ(1, dm.GetNumChecksumFailures());
+    EXPECT_FALSE(dm.ReadPageAsync(2, page.data()).get());
+    EXPECT_EQ(2, dm.GetNumChecksumFailures());
+
+    // Scenario: rewriting the page makes it good again.
+    dm.WritePage(2, data[2].data());
+    EXPECT_TRUE(dm.ReadPageAsync(2, page.data()).get());
+    EXPECT_EQ(data[2], page);
+    EXPECT_EQ(2, dm.GetNumChecksumFailures());
+
+    // Scenario: a restart after a crash, i.e. without this disk manager being shut down, still has the checksums.
+    std::vector<char> new_page(PAGE_SIZE);
+    snprintf(new_page.data(), PAGE_SIZE, "page 3, second version");
+    dm.WritePage(3, new_page.data());
+    dm.WritePage(num_pages, new_page.data());
+    {
+      DiskManager restarted_dm("test.db", false, true);
+      restarted_dm.ReadPage(3, page.data());
+      EXPECT_EQ(new_page, page);
+      restarted_dm.ReadPage(num_pages, page.data());
+      EXPECT_EQ(0, restarted_dm.GetNumChecksumFailures());
+
+      // the page write did not make it to disk before the crash: the old version is still good
+      file = fopen("test.db", "r+b");
+      ASSERT_NE(nullptr, file);
+      ASSERT_EQ(0, fseek(file, 3 * PAGE_SIZE, SEEK_SET));
+      ASSERT_EQ(PAGE_SIZE, fwrite(data[3].data(), 1, PAGE_SIZE, file));
+      fflush(file);
+      restarted_dm.ReadPage(3, page.data());
+      EXPECT_EQ(data[3], page);
+      EXPECT_EQ(0, restarted_dm.GetNumChecksumFailures());
+
+      // the page write was torn by the crash: neither version matches
+      ASSERT_EQ(0, fseek(file, 3 * PAGE_SIZE + PAGE_SIZE / 2, SEEK_SET));
+      ASSERT_EQ(PAGE_SIZE / 2, fwrite(new_page.data() + PAGE_SIZE / 2, 1, PAGE_SIZE / 2, file));
+      page[0] = 'x';
+      ASSERT_EQ(0, fseek(file, 3 * PAGE_SIZE, SEEK_SET));
+      ASSERT_EQ(1, fwrite(page.data(), 1, 1, file));
+      fclose(file);
+      EXPECT_FALSE(restarted_dm.ReadPageAsync(3, page.data()).get());
+      EXPECT_EQ(1, restarted_dm.GetNumChecksumFailures());
+      restarted_dm.ShutDown();
+    }
+    dm.ShutDown();
+  }
+
+  // Scenario: a run without checksums drops them, as the pages it writes would not match them any more.
+  {
+    DiskManager dm("test.db");
+    EXPECT_EQ(nullptr, fopen("test.crc", "rb"));
+    dm.WritePage(1, data[2].data());
+    dm.ShutDown();
+  }
+  {
+    DiskManager dm("test.db", false, true);
+    dm.ReadPage(1, page.data());
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    dm.ShutDown();
+  }
+}
+
+// The cost of checksums on writes, which write the checksum file through, and on reads of pages in the OS page cache.
+// A benchmark rather than a test, run with --gtest_also_run_disabled_tests.
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DISABLED_ChecksumThroughputTest) {
+  const page_id_t num_pages = 1024;
+  const int rounds = 50;
+  std::vector<char> page(PAGE_SIZE, 'x');
+  for (bool checksums : {false, true}) {
+    DiskManager dm("test.db", false, checksums);
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+      for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+        dm.WritePage(page_id, page.data());
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "writes " << (checksums ? "with" : "without") << " checksums: " << num_pages * rounds / elapsed.count()
+              << " pages/s" << std::endl;
+    start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+      for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+        dm.ReadPage(page_id, page.data());
+      }
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "reads of cached pages " << (checksums ? "with" : "without") << " checksums: "
+              << num_pages * rounds / elapsed.count() << " pages/s" << std::endl;
+    EXPECT_EQ(0, dm.GetNumChecksumFailures());
+    dm.ShutDown();
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 